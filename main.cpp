@@ -67,13 +67,18 @@ enum {PUBSUB_BUFFER_LENGTH = 16};
 r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
 #endif
 
+enum {TOPIC_INDEX_LENGTH = 32};
+r2p::Topic *topic_index_buf[TOPIC_INDEX_LENGTH];
+
 static WORKING_AREA(wa_info, 1024);
 
 r2p::Middleware r2p::Middleware::instance(R2P_MODULE_NAME, "BOOT_"R2P_MODULE_NAME
 #if R2P_USE_BRIDGE_MODE
 		, pubsub_buf, PUBSUB_BUFFER_LENGTH
+#else
+		, NULL, 0
 #endif
-		);
+		, topic_index_buf, TOPIC_INDEX_LENGTH);
 
 /*
  static WORKING_AREA(wa1, 1024);
@@ -201,6 +206,9 @@ int main(void) {
 #endif
 
 #if RTCANTRA
+	// Motor setpoints come from the PC through the bridge, with no timeout
+	rtcantra.set_priority("pwm2", 0);
+	rtcantra.set_priority("speed2", 0);
 	rtcantra.initialize(rtcan_config);
 #endif
 
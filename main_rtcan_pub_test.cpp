@@ -35,7 +35,11 @@ extern "C" void __cxa_pure_virtual() {
 static WORKING_AREA(wa_info, 1024);
 
 r2p::Bootloader r2p::Bootloader::instance(NULL);
-r2p::Middleware r2p::Middleware::instance("IMU_0", "BOOT_IMU_0");
+enum { TOPIC_INDEX_LENGTH = 16 };
+static r2p::Topic *topic_index_buf[TOPIC_INDEX_LENGTH];
+
+r2p::Middleware r2p::Middleware::instance("IMU_0", "BOOT_IMU_0", NULL, 0,
+		topic_index_buf, TOPIC_INDEX_LENGTH);
 
 static WORKING_AREA(wa1, 1024);
 static WORKING_AREA(wa2, 1024);
@@ -17,12 +17,15 @@ private:
 public:
   bool post_unsafe(Item item);
   bool fetch_unsafe(Item &item);
+  size_t fetch_n_unsafe(Item items[], size_t max_count);
+  bool peek_unsafe(Item &item) const;
   bool skip_unsafe();
 
   size_t get_length() const;
   size_t get_count() const;
   bool post(Item item);
   bool fetch(Item &item);
+  size_t fetch_n(Item items[], size_t max_count);
   bool skip();
 
 public:
@@ -63,6 +66,28 @@ bool ArrayQueue<Item>::fetch_unsafe(Item &item) {
 }
 
 
+template<typename Item> inline
+size_t ArrayQueue<Item>::fetch_n_unsafe(Item items[], size_t max_count) {
+
+  size_t n = 0;
+  while (n < max_count && fetch_unsafe(items[n])) {
+    ++n;
+  }
+  return n;
+}
+
+
+template<typename Item> inline
+bool ArrayQueue<Item>::peek_unsafe(Item &item) const {
+
+  if (count > 0) {
+    item = *headp;
+    return true;
+  }
+  return false;
+}
+
+
 template<typename Item> inline
 bool ArrayQueue<Item>::skip_unsafe() {
 
@@ -111,6 +136,16 @@ bool ArrayQueue<Item>::fetch(Item &item) {
 }
 
 
+template<typename Item> inline
+size_t ArrayQueue<Item>::fetch_n(Item items[], size_t max_count) {
+
+  SysLock::acquire();
+  size_t n = fetch_n_unsafe(items, max_count);
+  SysLock::release();
+  return n;
+}
+
+
 template<typename Item> inline
 bool ArrayQueue<Item>::skip() {
 
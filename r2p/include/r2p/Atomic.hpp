@@ -0,0 +1,35 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/impl/Atomic_.hpp>
+
+namespace r2p {
+
+
+class Atomic : private Uncopyable {
+private:
+  Atomic();
+
+public:
+  static void barrier();
+  static bool compare_and_swap(volatile size_t &value,
+                               size_t expected, size_t desired);
+};
+
+
+inline
+void Atomic::barrier() {
+
+  Atomic_::barrier();
+}
+
+
+inline
+bool Atomic::compare_and_swap(volatile size_t &value,
+                              size_t expected, size_t desired) {
+
+  return Atomic_::compare_and_swap(value, expected, desired);
+}
+
+
+} // namespace r2p
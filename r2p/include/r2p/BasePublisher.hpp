@@ -2,6 +2,7 @@
 
 #include <r2p/common.hpp>
 #include <r2p/Message.hpp>
+#include <r2p/Time.hpp>
 
 namespace r2p {
 
@@ -24,6 +25,7 @@ public:
   bool publish_remotely_unsafe(Message &msg);
 
   bool alloc(Message *&msgp);
+  bool alloc(Message *&msgp, const Time &timeout);
   bool publish(Message &msg);
   bool publish_locally(Message &msg);
   bool publish_remotely(Message &msg);
@@ -80,11 +82,25 @@ bool BasePublisher::alloc(Message *&msgp) {
 }
 
 
+inline
+bool BasePublisher::alloc(Message *&msgp, const Time &timeout) {
+
+  R2P_ASSERT(topicp != NULL);
+
+  msgp = topicp->alloc(timeout);
+  return msgp != NULL;
+}
+
+
 inline
 bool BasePublisher::publish_locally(Message &msg) {
 
   R2P_ASSERT(topicp != NULL);
 
+#if R2P_USE_TRAFFIC_COUNTERS
+  { SysLock::Scope lock;
+  topicp->count_publish_unsafe(); }
+#endif
   return topicp->notify_locals(msg, Time::now());
 }
 
@@ -94,6 +110,14 @@ bool BasePublisher::publish_remotely(Message &msg) {
 
   R2P_ASSERT(topicp != NULL);
 
+#if R2P_USE_TRAFFIC_COUNTERS
+  { SysLock::Scope lock;
+#if R2P_USE_BRIDGE_MODE
+  // Forwarded messages were already counted when published locally
+  if (msg.get_source() == NULL)
+#endif
+  topicp->count_publish_unsafe(); }
+#endif
   return topicp->notify_remotes(msg, Time::now());
 }
 
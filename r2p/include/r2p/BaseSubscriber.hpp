@@ -2,8 +2,12 @@
 
 #include <r2p/common.hpp>
 #include <r2p/MessagePtrQueue.hpp>
+#include <r2p/TimestampedMsgPtrQueue.hpp>
 #include <r2p/StaticList.hpp>
 #include <r2p/MemoryPool.hpp>
+#if R2P_USE_TRAFFIC_COUNTERS
+#include <r2p/TrafficCounters.hpp>
+#endif
 
 namespace r2p {
 
@@ -13,21 +17,34 @@ class Time;
 
 
 class BaseSubscriber : private Uncopyable {
+  friend class Topic;
+
 private:
   Topic *topicp;
 
+#if R2P_USE_TRAFFIC_COUNTERS
+protected:
+  TrafficCounters counters;
+#endif
+
 public:
   Topic *get_topic() const;
+#if R2P_USE_TRAFFIC_COUNTERS
+  const TrafficCounters &get_counters() const;
+#endif
   virtual size_t get_queue_length() const = 0;
   void notify_subscribed(Topic &topic);
 
   virtual bool notify_unsafe(Message &msg, const Time &timestamp) = 0;
   virtual bool fetch_unsafe(Message *&msgp, Time &timestamp) = 0;
   bool release_unsafe(Message &msg);
+  void release_n_unsafe(TimestampedMsgPtrQueue::Entry entries[],
+                        size_t count);
 
   virtual bool notify(Message &msg, const Time &timestamp) = 0;
   virtual bool fetch(Message *&msgp, Time &timestamp) = 0;
   bool release(Message &msg);
+  void release_n(TimestampedMsgPtrQueue::Entry entries[], size_t count);
 
 protected:
   BaseSubscriber();
@@ -45,6 +62,15 @@ Topic *BaseSubscriber::get_topic() const {
 }
 
 
+#if R2P_USE_TRAFFIC_COUNTERS
+inline
+const TrafficCounters &BaseSubscriber::get_counters() const {
+
+  return counters;
+}
+#endif
+
+
 inline
 void BaseSubscriber::notify_subscribed(Topic &topic) {
 
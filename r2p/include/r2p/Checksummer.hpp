@@ -81,8 +81,7 @@ uint8_t Checksummer::compute_checksum() const {
 inline
 bool Checksummer::check(uint8_t expected) const {
 
-  // XXX return compute_checksum() == expected;
-  (void)expected; return true;
+  return compute_checksum() == expected;
 }
 
 
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <r2p/common.hpp>
+
+namespace r2p {
+
+#if !defined(R2P_CRC_USE_SSE42) || defined(__DOXYGEN__)
+#if defined(__SSE4_2__)
+#define R2P_CRC_USE_SSE42           1
+#else
+#define R2P_CRC_USE_SSE42           0
+#endif
+#endif
+
+#if !defined(R2P_CRC_USE_SLICE_BY_8) || defined(__DOXYGEN__)
+#define R2P_CRC_USE_SLICE_BY_8      0
+#endif
+
+
+// CRC-16-CCITT: polynomial 0x1021, initial value 0xFFFF, not reflected
+class Crc16 {
+public:
+  typedef uint16_t Type;
+
+private:
+  Type crc;
+
+public:
+  Type compute_checksum() const;
+  bool check(Type expected) const;
+
+  void reset();
+  void add(const uint8_t value);
+  void add(const void *chunkp, size_t length);
+  template<typename T> void add(const T &value);
+
+public:
+  Crc16();
+
+public:
+  static Type update(Type crc, const uint8_t *chunkp, size_t length);
+
+private:
+  static const uint16_t table[256];
+};
+
+
+// CRC-32C (Castagnoli): polynomial 0x1EDC6F41, reflected, inverted
+class Crc32c {
+public:
+  typedef uint32_t Type;
+
+private:
+  Type crc;
+
+public:
+  Type compute_checksum() const;
+  bool check(Type expected) const;
+
+  void reset();
+  void add(const uint8_t value);
+  void add(const void *chunkp, size_t length);
+  template<typename T> void add(const T &value);
+
+public:
+  Crc32c();
+
+public:
+  static Type update(Type crc, const uint8_t *chunkp, size_t length);
+
+private:
+  static const uint32_t table[256];
+
+#if R2P_CRC_USE_SLICE_BY_8
+  // Tables for the bytes 1..7 positions ahead, built at static init
+  struct Slices {
+    uint32_t table[8][256];
+
+    Slices();
+  };
+
+  static Slices slices;
+#endif
+};
+
+
+inline
+Crc16::Type Crc16::compute_checksum() const {
+
+  return crc;
+}
+
+
+inline
+bool Crc16::check(Type expected) const {
+
+  return crc == expected;
+}
+
+
+inline
+void Crc16::reset() {
+
+  crc = 0xFFFF;
+}
+
+
+inline
+void Crc16::add(const uint8_t value) {
+
+  crc = static_cast<Type>((crc << 8) ^ table[(crc >> 8) ^ value]);
+}
+
+
+inline
+void Crc16::add(const void *chunkp, size_t length) {
+
+  crc = update(crc, reinterpret_cast<const uint8_t *>(chunkp), length);
+}
+
+
+template<typename T> inline
+void Crc16::add(const T &value) {
+
+  add(reinterpret_cast<const void *>(&value), sizeof(T));
+}
+
+
+inline
+Crc16::Crc16() : crc(0xFFFF) {}
+
+
+inline
+Crc32c::Type Crc32c::compute_checksum() const {
+
+  return ~crc;
+}
+
+
+inline
+bool Crc32c::check(Type expected) const {
+
+  return compute_checksum() == expected;
+}
+
+
+inline
+void Crc32c::reset() {
+
+  crc = 0xFFFFFFFF;
+}
+
+
+inline
+void Crc32c::add(const uint8_t value) {
+
+  crc = (crc >> 8) ^ table[(crc ^ value) & 0xFF];
+}
+
+
+inline
+void Crc32c::add(const void *chunkp, size_t length) {
+
+  crc = update(crc, reinterpret_cast<const uint8_t *>(chunkp), length);
+}
+
+
+template<typename T> inline
+void Crc32c::add(const T &value) {
+
+  add(reinterpret_cast<const void *>(&value), sizeof(T));
+}
+
+
+inline
+Crc32c::Crc32c() : crc(0xFFFFFFFF) {}
+
+
+} // namespace r2p
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/ArrayQueue.hpp>
+#include <r2p/Semaphore.hpp>
+#include <r2p/Thread.hpp>
+#include <r2p/Time.hpp>
+
+namespace r2p {
+
+class Node;
+
+
+// Runs many nodes on a fixed set of worker threads. A notified node is queued
+// once, on the worker that last ran it; a worker steals from the others only
+// when its own queue is empty. Each worker sleeps on its own semaphore, and
+// is woken only for work it can take. Callbacks of the same node never run
+// concurrently.
+// With spin(), the calling thread serves as the first worker, so a single
+// thread and stack can run all the nodes cooperatively.
+class Executor : private Uncopyable {
+public:
+  class Worker : private Uncopyable {
+    friend class Executor;
+
+  private:
+    Executor *executorp;
+    Thread *threadp;
+    ArrayQueue<Node *> ready_queue;
+    Semaphore wakeup_sem;
+    bool idle;        // Waiting for wakeup_sem, not yet signaled
+
+  public:
+    Thread *get_thread() const;
+
+  public:
+    Worker(Node *queue_buf[], size_t queue_length);
+  };
+
+private:
+  Worker *const *workerpp;
+  const size_t num_workers;
+  size_t num_nodes;
+  size_t next_worker;
+  bool stopped;
+
+public:
+  size_t get_num_workers() const;
+  bool is_stopped() const;
+
+  void add(Node &node);
+  bool start(size_t index, void *stackp, size_t stacklen,
+             Thread::Priority priority);
+  bool spin(const Time &timeout = Time::INFINITE);
+  void stop();
+
+  void schedule_unsafe(Node &node, size_t index);
+
+private:
+  void enqueue_unsafe(Node &node, size_t index);
+  void wake_unsafe(size_t index);
+  bool has_ready_unsafe() const;
+  bool wait_ready(size_t index, const Time &timeout);
+  Node *take_unsafe(size_t index);
+  bool run_next(size_t index);
+  void do_worker(size_t index);
+
+public:
+  Executor(Worker *workers[], size_t num_workers);
+
+private:
+  static Thread::Return worker_threadf(Thread::Argument arg);
+};
+
+
+// Cooperative executor with its own buffers, run by the calling thread
+template<unsigned MAX_NODES>
+class CooperativeExecutor : private Uncopyable {
+private:
+  Node *queue_buf[MAX_NODES];
+  Executor::Worker worker;
+  Executor::Worker *workerp;
+  Executor executor;
+
+public:
+  void add(Node &node);
+  bool spin(const Time &timeout = Time::INFINITE);
+
+public:
+  CooperativeExecutor();
+};
+
+
+inline
+Thread *Executor::Worker::get_thread() const {
+
+  return threadp;
+}
+
+
+inline
+size_t Executor::get_num_workers() const {
+
+  return num_workers;
+}
+
+
+inline
+bool Executor::is_stopped() const {
+
+  return stopped;
+}
+
+
+template<unsigned MAX_NODES> inline
+void CooperativeExecutor<MAX_NODES>::add(Node &node) {
+
+  executor.add(node);
+}
+
+
+template<unsigned MAX_NODES> inline
+bool CooperativeExecutor<MAX_NODES>::spin(const Time &timeout) {
+
+  return executor.spin(timeout);
+}
+
+
+template<unsigned MAX_NODES> inline
+CooperativeExecutor<MAX_NODES>::CooperativeExecutor()
+:
+  worker(queue_buf, MAX_NODES),
+  workerp(&worker),
+  executor(&workerp, 1)
+{}
+
+
+} // namespace r2p
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/Time.hpp>
+
+namespace r2p {
+
+#if !defined(R2P_LATENCY_NUM_BUCKETS) || defined(__DOXYGEN__)
+#define R2P_LATENCY_NUM_BUCKETS     16
+#endif
+
+
+// Bucket i counts latencies in [2^i, 2^(i+1)) us; the first bucket also
+// takes [0, 1) us, and the last one everything above
+class LatencyHistogram : private Uncopyable {
+public:
+  typedef uint16_t Count;
+
+  enum { NUM_BUCKETS = R2P_LATENCY_NUM_BUCKETS };
+
+private:
+  Count counts[NUM_BUCKETS];
+
+public:
+  Count get_count(size_t bucket) const;
+
+  void update(const Time &latency);
+  void reset();
+
+public:
+  LatencyHistogram();
+
+public:
+  static size_t compute_bucket(const Time &latency);
+};
+
+
+inline
+LatencyHistogram::Count LatencyHistogram::get_count(size_t bucket) const {
+
+  R2P_ASSERT(bucket < NUM_BUCKETS);
+
+  return counts[bucket];
+}
+
+
+inline
+void LatencyHistogram::update(const Time &latency) {
+
+  register Count &count = counts[compute_bucket(latency)];
+  if (count < static_cast<Count>(~0)) {
+    ++count; // Saturate instead of wrapping around
+  }
+}
+
+
+inline
+void LatencyHistogram::reset() {
+
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    counts[i] = 0;
+  }
+}
+
+
+inline
+LatencyHistogram::LatencyHistogram() {
+
+  reset();
+}
+
+
+inline
+size_t LatencyHistogram::compute_bucket(const Time &latency) {
+
+  const Time::Type us = latency.to_us_raw();
+  if (us < 2) return 0;
+  if (us >= (static_cast<Time::Type>(1) << (NUM_BUCKETS - 1))) {
+    return NUM_BUCKETS - 1;
+  }
+
+  const size_t bucket = (8 * sizeof(unsigned) - 1) -
+    static_cast<size_t>(__builtin_clz(static_cast<unsigned>(us)));
+  return (bucket < NUM_BUCKETS) ? bucket : (NUM_BUCKETS - 1);
+}
+
+
+} // namespace r2p
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/Checksummer.hpp>
+#include <r2p/Crc.hpp>
+
+namespace r2p {
+
+
+// Frame check selected at runtime, so that each link can pick its own
+class LinkChecksummer : private Uncopyable {
+public:
+  enum Algorithm {
+    SUM8,       // 8-bit additive, 1 byte
+    CRC16,      // CRC-16-CCITT, 2 bytes
+    CRC32C,     // CRC-32C, 4 bytes
+  };
+
+private:
+  const uint8_t algorithm;
+  Checksummer sum8;
+  Crc16 crc16;
+  Crc32c crc32c;
+
+public:
+  Algorithm get_algorithm() const;
+  size_t get_length() const;
+  uint32_t compute_checksum() const;
+  bool check(uint32_t expected) const;
+
+  void add(const uint8_t value);
+  void add(const void *chunkp, size_t length);
+  template<typename T> void add(const T &value);
+
+public:
+  LinkChecksummer(Algorithm algorithm);
+
+public:
+  static size_t get_length(Algorithm algorithm);
+};
+
+
+inline
+LinkChecksummer::Algorithm LinkChecksummer::get_algorithm() const {
+
+  return static_cast<Algorithm>(algorithm);
+}
+
+
+inline
+size_t LinkChecksummer::get_length() const {
+
+  return get_length(get_algorithm());
+}
+
+
+inline
+uint32_t LinkChecksummer::compute_checksum() const {
+
+  switch (algorithm) {
+  case CRC16:   return crc16.compute_checksum();
+  case CRC32C:  return crc32c.compute_checksum();
+  default:      return sum8.compute_checksum();
+  }
+}
+
+
+inline
+bool LinkChecksummer::check(uint32_t expected) const {
+
+  return compute_checksum() == expected;
+}
+
+
+inline
+void LinkChecksummer::add(const uint8_t value) {
+
+  switch (algorithm) {
+  case CRC16:   crc16.add(value); break;
+  case CRC32C:  crc32c.add(value); break;
+  default:      sum8.add(value); break;
+  }
+}
+
+
+inline
+void LinkChecksummer::add(const void *chunkp, size_t length) {
+
+  switch (algorithm) {
+  case CRC16:   crc16.add(chunkp, length); break;
+  case CRC32C:  crc32c.add(chunkp, length); break;
+  default:      sum8.add(chunkp, length); break;
+  }
+}
+
+
+template<typename T> inline
+void LinkChecksummer::add(const T &value) {
+
+  add(reinterpret_cast<const void *>(&value), sizeof(T));
+}
+
+
+inline
+LinkChecksummer::LinkChecksummer(Algorithm algorithm)
+:
+  algorithm(static_cast<uint8_t>(algorithm))
+{}
+
+
+inline
+size_t LinkChecksummer::get_length(Algorithm algorithm) {
+
+  switch (algorithm) {
+  case CRC16:   return sizeof(Crc16::Type);
+  case CRC32C:  return sizeof(Crc32c::Type);
+  default:      return sizeof(uint8_t);
+  }
+}
+
+
+} // namespace r2p
@@ -2,7 +2,10 @@
 #include <r2p/common.hpp>
 #include <r2p/BaseSubscriber.hpp>
 #include <r2p/StaticList.hpp>
-#include <r2p/MessagePtrQueue.hpp>
+#include <r2p/TimestampedMsgPtrQueue.hpp>
+#if R2P_USE_LATENCY_HISTOGRAMS
+#include <r2p/LatencyHistogram.hpp>
+#endif
 
 
 namespace r2p {
@@ -18,11 +21,23 @@ class LocalSubscriber : public BaseSubscriber {
 public:
   typedef bool (*Callback)(const Message &msg);
 
+  // What to do when a message is notified and the queue is full
+  enum OverflowPolicy {
+    DROP_NEWEST,  // Reject the incoming message
+    DROP_OLDEST,  // Release the oldest queued message
+    CONFLATE      // Keep only the latest message, whatever the queue length
+  };
+
 private:
   Node *nodep;
   const Callback callback;
-  MessagePtrQueue msgp_queue;
-  uint_least8_t event_index;
+  TimestampedMsgPtrQueue tmsgp_queue;
+  uint_least16_t event_index;
+  const uint_least8_t policy;
+  size_t num_expired;
+#if R2P_USE_LATENCY_HISTOGRAMS
+  LatencyHistogram latency;
+#endif
 
   mutable StaticList<LocalSubscriber>::Link by_node;
   mutable StaticList<LocalSubscriber>::Link by_topic;
@@ -30,18 +45,34 @@ private:
 public:
   Callback get_callback() const;
   size_t get_queue_length() const;
+  OverflowPolicy get_overflow_policy() const;
+  size_t get_num_expired() const;
+#if R2P_USE_LATENCY_HISTOGRAMS
+  const LatencyHistogram &get_latency() const;
+#endif
 
 public:
   bool fetch_unsafe(Message *&msgp, Time &timestamp);
+  size_t fetch_n_unsafe(TimestampedMsgPtrQueue::Entry entries[],
+                        size_t max_count);
+  bool peek_unsafe(TimestampedMsgPtrQueue::Entry &entry) const;
   bool notify_unsafe(Message &msg, const Time &timestamp);
 
   bool fetch(Message *&msgp);
   bool fetch(Message *&msgp, Time &timestamp);
+  size_t fetch_n(TimestampedMsgPtrQueue::Entry entries[], size_t max_count);
   bool notify(Message &msg, const Time &timestamp);
 
+private:
+  bool post_unsafe(Message &msg, const Time &timestamp);
+
 protected:
-  LocalSubscriber(Message *queue_buf[], size_t queue_length,
-                  Callback callback = NULL);
+  LocalSubscriber(TimestampedMsgPtrQueue::Entry queue_buf[],
+                  size_t queue_length,
+                  Callback callback = NULL,
+                  OverflowPolicy policy = DROP_NEWEST,
+                  TimestampedMsgPtrQueue::Kind queue_kind =
+                    TimestampedMsgPtrQueue::ARRAY);
   virtual ~LocalSubscriber() = 0;
 };
 
@@ -63,15 +94,64 @@ LocalSubscriber::Callback LocalSubscriber::get_callback() const {
 inline
 size_t LocalSubscriber::get_queue_length() const {
 
-  return msgp_queue.get_length();
+  return tmsgp_queue.get_length();
+}
+
+
+inline
+LocalSubscriber::OverflowPolicy
+LocalSubscriber::get_overflow_policy() const {
+
+  return static_cast<OverflowPolicy>(policy);
+}
+
+
+inline
+size_t LocalSubscriber::get_num_expired() const {
+
+  return num_expired;
+}
+
+
+#if R2P_USE_LATENCY_HISTOGRAMS
+inline
+const LatencyHistogram &LocalSubscriber::get_latency() const {
+
+  return latency;
+}
+#endif
+
+
+inline
+bool LocalSubscriber::post_unsafe(Message &msg, const Time &timestamp) {
+
+  if (policy != DROP_NEWEST) {
+    // Make room by returning the evicted messages to the pool
+    const size_t limit = (policy == CONFLATE) ? 1 : tmsgp_queue.get_length();
+    TimestampedMsgPtrQueue::Entry old;
+    while (tmsgp_queue.get_count_unsafe() >= limit &&
+           tmsgp_queue.fetch_unsafe(old)) {
+      release_unsafe(*old.msgp);
+    }
+  }
+  TimestampedMsgPtrQueue::Entry entry(&msg, timestamp);
+  if (tmsgp_queue.post_unsafe(entry)) {
+#if R2P_USE_TRAFFIC_COUNTERS
+    counters.update_queue_depth(tmsgp_queue.get_count_unsafe());
+#endif
+    return true;
+  }
+  return false;
 }
 
 
 inline
 bool LocalSubscriber::fetch_unsafe(Message *&msgp, Time &timestamp) {
 
-  if (msgp_queue.fetch_unsafe(msgp)) {
-    timestamp = Time::now();
+  TimestampedMsgPtrQueue::Entry entry;
+  if (tmsgp_queue.fetch_unsafe(entry)) {
+    msgp = entry.msgp;
+    timestamp = entry.timestamp;
     return true;
   }
   return false;
@@ -79,11 +159,24 @@ bool LocalSubscriber::fetch_unsafe(Message *&msgp, Time &timestamp) {
 
 
 inline
-bool LocalSubscriber::notify_unsafe(Message &msg, const Time &timestamp) {
+size_t LocalSubscriber::fetch_n_unsafe(TimestampedMsgPtrQueue::Entry entries[],
+                                       size_t max_count) {
+
+  return tmsgp_queue.fetch_n_unsafe(entries, max_count);
+}
+
 
-  (void)timestamp;
+inline
+bool LocalSubscriber::peek_unsafe(TimestampedMsgPtrQueue::Entry &entry) const {
+
+  return tmsgp_queue.peek_unsafe(entry);
+}
+
+
+inline
+bool LocalSubscriber::notify_unsafe(Message &msg, const Time &timestamp) {
 
-  if (nodep->get_enabled() && msgp_queue.post_unsafe(&msg)) {
+  if (nodep->get_enabled() && post_unsafe(msg, timestamp)) {
     nodep->notify_unsafe(event_index);
     return true;
   }
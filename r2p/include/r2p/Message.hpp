@@ -34,8 +34,10 @@ public:
   Transport *get_source() const;
   void set_source(Transport *sourcep);
 #endif
+  RefcountType get_refcount_unsafe() const;
 
   void acquire_unsafe();
+  void acquire_n_unsafe(size_t count);
   bool release_unsafe();
   void reset_unsafe();
 
@@ -100,6 +102,13 @@ void Message::set_source(Transport *sourcep) {
 #endif // R2P_USE_BRIDGE_MODE
 
 
+inline
+Message::RefcountType Message::get_refcount_unsafe() const {
+
+  return refcount;
+}
+
+
 inline
 void Message::acquire_unsafe() {
 
@@ -109,6 +118,16 @@ void Message::acquire_unsafe() {
 }
 
 
+inline
+void Message::acquire_n_unsafe(size_t count) {
+
+  R2P_ASSERT(count < ((1 << (8 * sizeof(refcount) - 1)) - 1));
+  R2P_ASSERT(refcount < ((1 << (8 * sizeof(refcount) - 1)) - 1) - count);
+
+  refcount += static_cast<RefcountType>(count);
+}
+
+
 inline
 bool Message::release_unsafe() {
 
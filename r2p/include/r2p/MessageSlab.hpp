@@ -0,0 +1,89 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/impl/SimplePool_.hpp>
+#include <r2p/Semaphore.hpp>
+#include <r2p/Time.hpp>
+
+namespace r2p {
+
+#if !defined(R2P_SLAB_NUM_CLASSES) || defined(__DOXYGEN__)
+#define R2P_SLAB_NUM_CLASSES        8
+#endif
+
+
+// Message blocks shared by all the topics, one free list per message size.
+// Blocks are exactly as large as the messages, so a buffer of N messages
+// carves into N blocks, as it would for a topic pool; topics of the same
+// size share them. Classes are claimed by the first topic of each size.
+// Topics keep their own quota; the slab only holds the free blocks.
+class MessageSlab : private Uncopyable {
+public:
+  enum { NUM_CLASSES = R2P_SLAB_NUM_CLASSES };
+
+private:
+  SimplePool_ pools[NUM_CLASSES];
+  uint16_t block_sizes[NUM_CLASSES]; // 0 if not claimed yet
+  Semaphore free_sem;
+  size_t num_free_waiters;
+
+public:
+  size_t get_block_size(size_t index) const;
+  size_t find_class(size_t type_size);
+
+  void *alloc_unsafe(size_t index);
+  void free_unsafe(size_t index, void *blockp);
+  bool wait_free_unsafe(const Time &timeout);
+
+  size_t grow(size_t index, void *bufp, size_t buflen);
+  size_t grow(void *bufp, size_t buflen, size_t type_size);
+
+public:
+  MessageSlab();
+
+public:
+  static MessageSlab instance;
+};
+
+
+inline
+size_t MessageSlab::get_block_size(size_t index) const {
+
+  R2P_ASSERT(index < NUM_CLASSES);
+
+  return block_sizes[index];
+}
+
+
+inline
+void *MessageSlab::alloc_unsafe(size_t index) {
+
+  R2P_ASSERT(index < NUM_CLASSES);
+
+  return pools[index].alloc_unsafe();
+}
+
+
+inline
+void MessageSlab::free_unsafe(size_t index, void *blockp) {
+
+  R2P_ASSERT(index < NUM_CLASSES);
+
+  pools[index].free_unsafe(blockp);
+
+  // Waiters may be stuck on their quota or on another size: wake them all,
+  // those who cannot take a block wait again
+  for (size_t i = 0; i < num_free_waiters; ++i) {
+    free_sem.signal_unsafe();
+  }
+}
+
+
+inline
+size_t MessageSlab::grow(void *bufp, size_t buflen, size_t type_size) {
+
+  return grow(find_class(type_size), bufp, buflen);
+}
+
+
+} // namespace r2p
@@ -27,6 +27,12 @@ public:
 
     // Path messages
     PATH                = 0x31,
+
+    // Statistics messages
+    LATENCY_REQUEST     = 0x41,
+    LATENCY_RESPONSE    = 0x42,
+    TRAFFIC_REQUEST     = 0x43,
+    TRAFFIC_RESPONSE    = 0x44,
   };
 
   enum { MAX_PAYLOAD_LENGTH = 31 };
@@ -46,6 +52,33 @@ public:
     uint8_t     raw_params[MAX_RAW_PARAMS_LENGTH];
   } R2P_PACKED;
 
+  struct Latency {
+    enum { MAX_COUNTS = 7 };
+    enum { LAST = 0x80 }; // In first_bucket, ends a complete report
+
+    char        topic[NamingTraits<Topic>::MAX_LENGTH];
+    uint8_t     first_bucket;
+    uint16_t    counts[MAX_COUNTS];
+  } R2P_PACKED;
+
+  struct TrafficRequest {
+    char        module[NamingTraits<Middleware>::MAX_LENGTH];
+    uint16_t    period_ms;  // 0 for a single report
+  } R2P_PACKED;
+
+  struct Traffic {
+    enum SourceEnum { TOPIC, LOCAL_SUBSCRIBER, REMOTE_SUBSCRIBER };
+    enum { LAST = 0x80 }; // In source, ends a complete report
+
+    char        topic[NamingTraits<Topic>::MAX_LENGTH];
+    uint8_t     source;
+    uint32_t    publishes;
+    uint32_t    deliveries;
+    uint16_t    queue_drops;
+    uint16_t    alloc_failures;
+    uint16_t    max_queue_depth;
+  } R2P_PACKED;
+
   struct Module {
     char    name[NamingTraits<Middleware>::MAX_LENGTH];
     uint8_t reserved_;
@@ -62,6 +95,9 @@ public:
     uint8_t payload[MAX_PAYLOAD_LENGTH];
     Path    path;
     PubSub  pubsub;
+    Latency latency;
+    TrafficRequest traffic_request;
+    Traffic traffic;
     Module  module;
   } R2P_PACKED;
   uint8_t type;
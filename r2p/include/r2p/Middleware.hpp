@@ -3,6 +3,7 @@
 #include <r2p/common.hpp>
 #include <r2p/StaticList.hpp>
 #include <r2p/Topic.hpp>
+#include <r2p/TopicIndex.hpp>
 #include <r2p/Thread.hpp>
 #include <r2p/MemoryPool.hpp>
 #include <r2p/MgmtMsg.hpp>
@@ -12,8 +13,6 @@
 #include <r2p/Node.hpp>
 #include <r2p/Bootloader.hpp>
 #include <r2p/ReMutex.hpp>
-#include <r2p/transport/DebugTransport.hpp>
-#include <r2p/transport/RTCANTransport.hpp>
 
 namespace r2p {
 
@@ -48,9 +47,11 @@ private:
   const char *const module_namep;
   StaticList<Node> nodes;
   StaticList<Topic> topics;
+  TopicIndex topic_index;
   StaticList<Transport> transports;
   ReMutex lists_lock;
-
+  bool stopped;
+  size_t num_running_nodes;
 
   enum { MGMT_BUFFER_LENGTH = 10 };
   enum { MGMT_TIMEOUT_MS = 33 };
@@ -62,7 +63,7 @@ private:
   Node mgmt_node;
   Publisher<MgmtMsg> mgmt_pub;
   SubscriberExtBuf<MgmtMsg> mgmt_sub;
-  MgmtMsg *mgmt_queue_buf[MGMT_BUFFER_LENGTH];
+  TimestampedMsgPtrQueue::Entry mgmt_queue_buf[MGMT_BUFFER_LENGTH];
   MgmtMsg mgmt_msg_buf[MGMT_BUFFER_LENGTH];
 
 #if R2P_USE_BOOTLOADER
@@ -88,9 +89,15 @@ private:
   StaticList<LocalSubscriber>::ConstIterator iter_subscribers;
   Time iter_lasttime;
 #endif
-
-  bool stopped;
-  size_t num_running_nodes;
+#if R2P_USE_LATENCY_HISTOGRAMS
+  bool latency_pending;
+  size_t latency_chunk;
+  MgmtMsg *latency_lastp;
+#endif
+#if R2P_USE_TRAFFIC_COUNTERS
+  Time traffic_period;
+  Time traffic_lasttime;
+#endif
 
 public:
   static Middleware instance;
@@ -117,6 +124,13 @@ public:
 
   bool stop_remote(const char *namep);
   bool reboot_remote(const char *namep, bool bootload = false);
+#if R2P_USE_LATENCY_HISTOGRAMS
+  bool request_latency_remote(const char *namep);
+#endif
+#if R2P_USE_TRAFFIC_COUNTERS
+  bool request_traffic_remote(const char *namep,
+                              const Time &period = Time::IMMEDIATE);
+#endif
 
   void add(Node &node);
   void add(Transport &transport);
@@ -139,11 +153,13 @@ public:
   Node *find_node(const char *namep);
 
 private:
+  void link_topic(Topic &topic);
   Topic *touch_topic(const char *namep, size_t type_size);
 
 private:
   Middleware(const char *module_namep, const char *bootloader_namep,
-             PubSubStep pubsub_buf[] = NULL, size_t pubsub_length = 0);
+             PubSubStep pubsub_buf[] = NULL, size_t pubsub_length = 0,
+             Topic *topic_index_buf[] = NULL, size_t topic_index_length = 0);
 
 private:
   static Thread::Return mgmt_threadf(Thread::Argument);
@@ -151,6 +167,24 @@ private:
   void do_cmd_advertise(const MgmtMsg &msg);
   void do_cmd_subscribe_request(const MgmtMsg &msg);
   void do_cmd_subscribe_response(const MgmtMsg &msg);
+#if R2P_USE_LATENCY_HISTOGRAMS
+  void do_cmd_latency_request(const MgmtMsg &msg);
+  void publish_latency();
+  bool snapshot_local_latency(size_t index, size_t first,
+                              const char *&topic_namep,
+                              LatencyHistogram::Count counts[]);
+#endif
+#if R2P_USE_LATENCY_HISTOGRAMS || R2P_USE_TRAFFIC_COUNTERS
+  void publish_report(MgmtMsg *msgp);
+#endif
+#if R2P_USE_TRAFFIC_COUNTERS
+  void do_cmd_traffic_request(const MgmtMsg &msg);
+  void publish_traffic();
+  bool snapshot_local_traffic(size_t index, const char *&topic_namep,
+                              TrafficCounters &counters);
+  bool publish_traffic(MgmtMsg *&lastp, const char *topicp, uint8_t source,
+                       const TrafficCounters &counters);
+#endif
 #if R2P_USE_BRIDGE_MODE
   PubSubStep *alloc_pubsub_step();
 #endif
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/Atomic.hpp>
+
+namespace r2p {
+
+
+// Multi-producer single-consumer bounded ring buffer, with the same interface
+// as ArrayQueue. Producers claim a slot with a compare-and-swap on the tail,
+// then publish it through the per-slot sequence number, so that neither side
+// needs SysLock. A producer preempted between the two steps only hides the
+// following slots from the consumer, it never blocks the other producers.
+//
+// Item must provide a "volatile size_t seq" member, owned by the queue, which
+// its assignment operator must not copy.
+template<typename Item>
+class MpscQueue : private Uncopyable {
+private:
+  Item *arrayp;
+  size_t length;
+  size_t wrap;
+  volatile size_t head;
+  volatile size_t tail;
+
+public:
+  bool post_unsafe(Item item);
+  bool fetch_unsafe(Item &item);
+  size_t fetch_n_unsafe(Item items[], size_t max_count);
+  bool peek_unsafe(Item &item) const;
+  bool skip_unsafe();
+
+  size_t get_length() const;
+  size_t get_count() const;
+  bool post(Item item);
+  bool fetch(Item &item);
+  size_t fetch_n(Item items[], size_t max_count);
+  bool skip();
+
+private:
+  size_t advance(size_t index, size_t n) const;
+  ptrdiff_t distance(size_t to, size_t from) const;
+  Item &cell(size_t index) const;
+
+public:
+  MpscQueue(Item array[], size_t length);
+};
+
+
+// Indexes and sequence numbers run over a multiple of the length, as large as
+// possible, so that a stalled producer cannot mistake an index for a newer one
+
+
+template<typename Item> inline
+size_t MpscQueue<Item>::advance(size_t index, size_t n) const {
+
+  index += n;
+  return (index < wrap) ? index : (index - wrap);
+}
+
+
+template<typename Item> inline
+ptrdiff_t MpscQueue<Item>::distance(size_t to, size_t from) const {
+
+  const size_t d = (to >= from) ? (to - from) : (to + wrap - from);
+  return (d <= (wrap >> 1)) ? static_cast<ptrdiff_t>(d)
+                            : -static_cast<ptrdiff_t>(wrap - d);
+}
+
+
+template<typename Item> inline
+Item &MpscQueue<Item>::cell(size_t index) const {
+
+  return arrayp[index % length];
+}
+
+
+template<typename Item> inline
+bool MpscQueue<Item>::post_unsafe(Item item) {
+
+  size_t t = tail;
+  for (;;) {
+    const ptrdiff_t d = distance(cell(t).seq, t);
+    if (d == 0) {
+      // Slot free for this lap, try to claim it
+      if (Atomic::compare_and_swap(tail, t, advance(t, 1))) break;
+    } else if (d < 0) {
+      return false; // Full
+    }
+    t = tail;
+  }
+
+  Item &c = cell(t);
+  c = item;
+  Atomic::barrier();
+  c.seq = advance(t, 1);
+  return true;
+}
+
+
+template<typename Item> inline
+bool MpscQueue<Item>::fetch_unsafe(Item &item) {
+
+  const size_t h = head;
+  Item &c = cell(h);
+  if (distance(c.seq, advance(h, 1)) < 0) return false;
+
+  Atomic::barrier();
+  item = c;
+  Atomic::barrier();
+  c.seq = advance(h, length);
+  head = advance(h, 1);
+  return true;
+}
+
+
+template<typename Item> inline
+size_t MpscQueue<Item>::fetch_n_unsafe(Item items[], size_t max_count) {
+
+  size_t n = 0;
+  while (n < max_count && fetch_unsafe(items[n])) {
+    ++n;
+  }
+  return n;
+}
+
+
+template<typename Item> inline
+bool MpscQueue<Item>::peek_unsafe(Item &item) const {
+
+  const size_t h = head;
+  const Item &c = cell(h);
+  if (distance(c.seq, advance(h, 1)) < 0) return false;
+
+  Atomic::barrier();
+  item = c;
+  return true;
+}
+
+
+template<typename Item> inline
+bool MpscQueue<Item>::skip_unsafe() {
+
+  const size_t h = head;
+  Item &c = cell(h);
+  if (distance(c.seq, advance(h, 1)) < 0) return false;
+
+  Atomic::barrier();
+  c.seq = advance(h, length);
+  head = advance(h, 1);
+  return true;
+}
+
+
+template<typename Item> inline
+size_t MpscQueue<Item>::get_length() const {
+
+  return length;
+}
+
+
+template<typename Item> inline
+size_t MpscQueue<Item>::get_count() const {
+
+  // Includes the slots claimed but not yet published
+  const ptrdiff_t d = distance(tail, head);
+  return (d > 0) ? static_cast<size_t>(d) : 0;
+}
+
+
+template<typename Item> inline
+bool MpscQueue<Item>::post(Item item) {
+
+  return post_unsafe(item);
+}
+
+
+template<typename Item> inline
+bool MpscQueue<Item>::fetch(Item &item) {
+
+  return fetch_unsafe(item);
+}
+
+
+template<typename Item> inline
+size_t MpscQueue<Item>::fetch_n(Item items[], size_t max_count) {
+
+  return fetch_n_unsafe(items, max_count);
+}
+
+
+template<typename Item> inline
+bool MpscQueue<Item>::skip() {
+
+  return skip_unsafe();
+}
+
+
+template<typename Item> inline
+MpscQueue<Item>::MpscQueue(Item array[], size_t length)
+:
+  arrayp(array),
+  length(length),
+  wrap((length > 0) ? (~static_cast<size_t>(0) >> 1) / length * length : 0),
+  head(0),
+  tail(0)
+{
+  R2P_ASSERT(array != NULL);
+  R2P_ASSERT(length > 0);
+
+  for (size_t i = 0; i < length; ++i) {
+    arrayp[i].seq = i;
+  }
+}
+
+
+} // namespace r2p
@@ -4,13 +4,24 @@
 #include <r2p/NamingTraits.hpp>
 #include <r2p/StaticList.hpp>
 #include <r2p/SpinEvent.hpp>
+#include <r2p/Executor.hpp>
 #include <r2p/Time.hpp>
 #include <r2p/MgmtMsg.hpp>
 
 namespace r2p {
 
+#if !defined(R2P_NODE_SPIN_BATCH_LENGTH) || defined(__DOXYGEN__)
+#define R2P_NODE_SPIN_BATCH_LENGTH  4
+#endif
+
+// One table entry per SpinEvent index, 32 per group on ChibiOS
+#if !defined(R2P_NODE_MAX_SUBSCRIBERS) || defined(__DOXYGEN__)
+#define R2P_NODE_MAX_SUBSCRIBERS    (32 * R2P_SPINEVENT_NUM_GROUPS)
+#endif
+
 class Message;
 class Topic;
+class Executor;
 class LocalPublisher;
 class LocalSubscriber;
 template<typename MessageType> class Publisher;
@@ -20,13 +31,24 @@ template<typename MessageType, unsigned QUEUE_LENGTH> class Subscriber;
 
 class Node : private Uncopyable {
   friend class Middleware;
+  friend class Executor;
+
+public:
+  enum { MAX_SUBSCRIBERS = R2P_NODE_MAX_SUBSCRIBERS };
 
 private:
+  enum ExecState { IDLE, QUEUED, RUNNING, RERUN };
+
   const char *const namep;
   StaticList<LocalPublisher> publishers;
   StaticList<LocalSubscriber> subscribers;
+  LocalSubscriber *event_subscribers[MAX_SUBSCRIBERS];
   SpinEvent event;
   Time timeout;
+  Executor *executorp;
+  uint_least8_t exec_state;
+  uint_least8_t exec_worker;  // Last to run it, queued there again
+  bool enabled;
 
   mutable StaticList<Node>::Link by_middleware;
 
@@ -56,6 +78,10 @@ public:
   bool spin(const Time &timeout = Time::INFINITE);
 
 private:
+  void dispatch(SpinEvent::Mask summary, SpinEvent::Mask masks[]);
+  void dispatch_all();
+  LocalSubscriber *select_earliest(SpinEvent::Mask &summary,
+                                   SpinEvent::Mask masks[]);
   bool advertise(LocalPublisher &pub, const char *namep,
                  const Time &publish_timeout, size_t msg_size);
   bool subscribe(LocalSubscriber &sub, const char *namep,
@@ -102,14 +128,18 @@ const StaticList<LocalSubscriber> &Node::get_subscribers() const {
 inline
 bool Node::get_enabled() const {
 
-  return event.get_thread() != NULL;
+  return enabled;
 }
 
 
 inline
 void Node::set_enabled(bool enabled) {
 
-  event.set_thread(enabled ? &Thread::self() : NULL);
+  // Nodes run by an executor are not bound to a thread
+  this->enabled = enabled;
+  if (executorp == NULL) {
+    event.set_thread(enabled ? &Thread::self() : NULL);
+  }
 }
 
 
@@ -139,7 +169,11 @@ bool Node::subscribe(Subscriber<MT, QL> &sub, const char *namep) {
 inline
 void Node::notify_unsafe(unsigned event_index) {
 
-  event.signal_unsafe(event_index);
+  if (executorp != NULL) {
+    executorp->schedule_unsafe(*this, exec_worker);
+  } else {
+    event.signal_unsafe(event_index);
+  }
 }
 
 
@@ -147,14 +181,20 @@ inline
 void Node::notify_stop_unsafe() {
 
   // Just signal a dummy unlikely event
-  event.signal_unsafe(SpinEvent::MAX_INDEX);
+  notify_unsafe(SpinEvent::MAX_INDEX);
 }
 
 
 inline
 void Node::notify(unsigned event_index) {
 
-  event.signal(event_index);
+  if (executorp != NULL) {
+    SysLock::acquire();
+    executorp->schedule_unsafe(*this, exec_worker);
+    SysLock::release();
+  } else {
+    event.signal(event_index);
+  }
 }
 
 
@@ -162,7 +202,7 @@ inline
 void Node::notify_stop() {
 
   // Just signal a dummy unlikely event
-  event.signal(SpinEvent::MAX_INDEX);
+  notify(SpinEvent::MAX_INDEX);
 }
 
 
@@ -12,6 +12,7 @@ template<typename MessageType>
 class Publisher : public LocalPublisher {
 public:
   bool alloc(MessageType *&msgp);
+  bool alloc(MessageType *&msgp, const Time &timeout);
   bool publish(MessageType &msg);
 
 public:
@@ -28,6 +29,14 @@ bool Publisher<MessageType>::alloc(MessageType *&msgp) {
 }
 
 
+template<typename MessageType> inline
+bool Publisher<MessageType>::alloc(MessageType *&msgp, const Time &timeout) {
+
+  static_cast_check<MessageType, Message>();
+  return BasePublisher::alloc(reinterpret_cast<Message *&>(msgp), timeout);
+}
+
+
 template<typename MessageType> inline
 bool Publisher<MessageType>::publish(MessageType &msg) {
 
@@ -2,12 +2,14 @@
 
 #include <r2p/common.hpp>
 #include <r2p/Mutex.hpp>
+#include <r2p/Thread.hpp>
 
 namespace r2p {
 
 
 class ReMutex : private Uncopyable {
 private:
+  Thread *ownerp;
   size_t counter;
   Mutex mutex;
 
@@ -29,6 +31,7 @@ public:
 inline
 void ReMutex::initialize() {
 
+  ownerp = NULL;
   counter = 0;
   mutex.initialize();
 }
@@ -37,9 +40,13 @@ void ReMutex::initialize() {
 inline
 void ReMutex::acquire_unsafe() {
 
-  if (++counter == 1) {
+  // Other threads wait for the owner to leave, not only the first one
+  Thread *selfp = &Thread::self();
+  if (ownerp != selfp) {
     mutex.acquire_unsafe();
+    ownerp = selfp;
   }
+  ++counter;
 }
 
 
@@ -47,8 +54,10 @@ inline
 void ReMutex::release_unsafe() {
 
   R2P_ASSERT(counter > 0);
+  R2P_ASSERT(ownerp == &Thread::self());
 
   if (--counter == 0) {
+    ownerp = NULL;
     mutex.release_unsafe();
   }
 }
@@ -75,6 +84,7 @@ void ReMutex::release() {
 inline
 ReMutex::ReMutex()
 :
+  ownerp(NULL),
   counter(0),
   mutex()
 {}
@@ -83,6 +93,7 @@ ReMutex::ReMutex()
 inline
 ReMutex::ReMutex(bool initialize)
 :
+  ownerp(NULL),
   counter(0),
   mutex(initialize)
 {}
@@ -2,6 +2,7 @@
 
 #include <r2p/common.hpp>
 #include <r2p/BaseSubscriber.hpp>
+#include <r2p/TimestampedMsgPtrQueue.hpp>
 
 namespace r2p {
 
@@ -15,14 +16,37 @@ class RemoteSubscriber : public BaseSubscriber {
 private:
   Transport *transportp;
 
+protected:
+  TimestampedMsgPtrQueue tmsgp_queue;
+
+private:
   mutable StaticList<RemoteSubscriber>::Link by_transport;
   mutable StaticList<RemoteSubscriber>::Link by_topic;
 
+  // Transmission scheduler heap node, guarded by SysLock
+  RemoteSubscriber *tx_leftp;
+  RemoteSubscriber *tx_rightp;
+  size_t tx_weight;   // Nodes of the subtree, 0 while not scheduled
+  Time tx_deadline;   // Of the queue head
+
 public:
   Transport *get_transport() const;
+  size_t get_queue_length() const;
+  size_t get_queue_count() const;
+
+  bool peek_unsafe(TimestampedMsgPtrQueue::Entry &entry) const;
+  bool fetch_unsafe(Message *&msgp, Time &timestamp);
+  bool notify_unsafe(Message &msg, const Time &timestamp);
+
+  bool fetch(Message *&msgp, Time &timestamp);
+  bool notify(Message &msg, const Time &timestamp);
 
 protected:
-  RemoteSubscriber(Transport &transport);
+  RemoteSubscriber(Transport &transport,
+                   TimestampedMsgPtrQueue::Entry queue_buf[],
+                   size_t queue_length,
+                   TimestampedMsgPtrQueue::Kind queue_kind =
+                     TimestampedMsgPtrQueue::ARRAY);
   virtual ~RemoteSubscriber() = 0;
 };
 
@@ -34,4 +58,46 @@ Transport *RemoteSubscriber::get_transport() const {
 }
 
 
+inline
+size_t RemoteSubscriber::get_queue_length() const {
+
+  return tmsgp_queue.get_length();
+}
+
+
+inline
+size_t RemoteSubscriber::get_queue_count() const {
+
+  return tmsgp_queue.get_count();
+}
+
+
+inline
+bool RemoteSubscriber::peek_unsafe(TimestampedMsgPtrQueue::Entry &entry)
+const {
+
+  return tmsgp_queue.peek_unsafe(entry);
+}
+
+
+inline
+bool RemoteSubscriber::notify(Message &msg, const Time &timestamp) {
+
+  SysLock::acquire();
+  bool success = notify_unsafe(msg, timestamp);
+  SysLock::release();
+  return success;
+}
+
+
+inline
+bool RemoteSubscriber::fetch(Message *&msgp, Time &timestamp) {
+
+  SysLock::acquire();
+  bool success = fetch_unsafe(msgp, timestamp);
+  SysLock::release();
+  return success;
+}
+
+
 } // namespace r2p
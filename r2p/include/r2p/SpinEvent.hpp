@@ -4,18 +4,30 @@
 #include <r2p/impl/SpinEvent_.hpp>
 #include <r2p/Time.hpp>
 #include <r2p/Thread.hpp>
+#include <r2p/SysLock.hpp>
 
 namespace r2p {
 
+#if !defined(R2P_SPINEVENT_NUM_GROUPS) || defined(__DOXYGEN__)
+#define R2P_SPINEVENT_NUM_GROUPS    1
+#endif
 
+
+// With more than one group, each thread event flags a group, and the
+// actual event bits are kept in the group masks (two-level scheme)
 class SpinEvent : private Uncopyable {
 public:
   typedef SpinEvent_::Mask Mask;
 
-  enum { MAX_INDEX = (sizeof(Mask) * 8) - 1 };
+  enum { MASK_WIDTH = sizeof(Mask) * 8 };
+  enum { NUM_GROUPS = R2P_SPINEVENT_NUM_GROUPS };
+  enum { MAX_INDEX = (NUM_GROUPS * MASK_WIDTH) - 1 };
 
 private:
   SpinEvent_ impl;
+#if R2P_SPINEVENT_NUM_GROUPS > 1
+  Mask group_masks[NUM_GROUPS];
+#endif
 
 public:
   Thread *get_thread() const;
@@ -24,10 +36,13 @@ public:
   void signal_unsafe(unsigned event_index);
 
   void signal(unsigned event_index);
-  Mask wait(const Time &timeout);
+  Mask wait(const Time &timeout, Mask masks[]);
 
 public:
   SpinEvent(Thread *threadp = &Thread::self());
+
+public:
+  static unsigned lowest_index(Mask mask);
 };
 
 
@@ -48,21 +63,64 @@ void SpinEvent::set_thread(Thread *threadp) {
 inline
 void SpinEvent::signal_unsafe(unsigned event_index) {
 
+  R2P_ASSERT(event_index <= MAX_INDEX);
+
+#if R2P_SPINEVENT_NUM_GROUPS > 1
+  if (impl.get_thread() != NULL) {
+    const unsigned group = event_index / MASK_WIDTH;
+    group_masks[group] |= static_cast<Mask>(1) << (event_index % MASK_WIDTH);
+    impl.signal_unsafe(group);
+  }
+#else
   impl.signal_unsafe(event_index);
+#endif
 }
 
 
 inline
 void SpinEvent::signal(unsigned event_index) {
 
+#if R2P_SPINEVENT_NUM_GROUPS > 1
+  SysLock::acquire();
+  signal_unsafe(event_index);
+  SysLock::release();
+#else
   impl.signal(event_index);
+#endif
+}
+
+
+// Returns the summary of the signaled groups; masks[group] is filled in only
+// for the groups set in the summary
+inline
+SpinEvent::Mask SpinEvent::wait(const Time &timeout, Mask masks[]) {
+
+  Mask summary = impl.wait(timeout);
+#if R2P_SPINEVENT_NUM_GROUPS > 1
+  SysLock::acquire();
+  for (Mask pending = summary; pending != 0; pending &= pending - 1) {
+    const unsigned group = lowest_index(pending);
+    masks[group] = group_masks[group];
+    group_masks[group] = 0;
+  }
+  SysLock::release();
+#else
+  masks[0] = summary;
+  summary = (summary != 0) ? 1 : 0;
+#endif
+  return summary;
 }
 
 
 inline
-SpinEvent::Mask SpinEvent::wait(const Time &timeout) {
+unsigned SpinEvent::lowest_index(Mask mask) {
 
-  return impl.wait(timeout);
+  R2P_ASSERT(mask != 0);
+
+  // Count trailing zeros, single instruction pair (RBIT + CLZ) on Cortex-M3
+  return static_cast<unsigned>(
+    __builtin_ctzl(static_cast<unsigned long>(mask))
+  );
 }
 
 
@@ -70,7 +128,14 @@ inline
 SpinEvent::SpinEvent(Thread *threadp)
 :
   impl(threadp)
-{}
+{
+#if R2P_SPINEVENT_NUM_GROUPS > 1
+  R2P_ASSERT(NUM_GROUPS <= MASK_WIDTH);
+  for (unsigned i = 0; i < NUM_GROUPS; ++i) {
+    group_masks[i] = 0;
+  }
+#endif
+}
 
 
 } // namespace r2p
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/Atomic.hpp>
+
+namespace r2p {
+
+
+// Single-producer single-consumer ring buffer, with the same interface as
+// ArrayQueue. Producer and consumer do not need SysLock, as long as there is
+// only one of each at a time (e.g. producers serialized by SysLock); the
+// plain methods are thus the same as the *_unsafe ones.
+template<typename Item>
+class SpscQueue : private Uncopyable {
+private:
+  Item *arrayp;
+  size_t length;
+  volatile size_t head;
+  volatile size_t tail;
+
+public:
+  bool post_unsafe(Item item);
+  bool fetch_unsafe(Item &item);
+  size_t fetch_n_unsafe(Item items[], size_t max_count);
+  bool peek_unsafe(Item &item) const;
+  bool skip_unsafe();
+
+  size_t get_length() const;
+  size_t get_count() const;
+  bool post(Item item);
+  bool fetch(Item &item);
+  size_t fetch_n(Item items[], size_t max_count);
+  bool skip();
+
+private:
+  size_t next(size_t index) const;
+  size_t slot(size_t index) const;
+  size_t count(size_t head, size_t tail) const;
+
+public:
+  SpscQueue(Item array[], size_t length);
+};
+
+
+// Indexes run over twice the length, so that full and empty differ
+
+
+template<typename Item> inline
+size_t SpscQueue<Item>::next(size_t index) const {
+
+  return (++index < (length << 1)) ? index : 0;
+}
+
+
+template<typename Item> inline
+size_t SpscQueue<Item>::slot(size_t index) const {
+
+  return (index < length) ? index : (index - length);
+}
+
+
+template<typename Item> inline
+size_t SpscQueue<Item>::count(size_t head, size_t tail) const {
+
+  return (tail >= head) ? (tail - head) : ((length << 1) - head + tail);
+}
+
+
+template<typename Item> inline
+bool SpscQueue<Item>::post_unsafe(Item item) {
+
+  size_t t = tail;
+  if (count(head, t) < length) {
+    arrayp[slot(t)] = item;
+    Atomic::barrier();
+    tail = next(t);
+    return true;
+  }
+  return false;
+}
+
+
+template<typename Item> inline
+bool SpscQueue<Item>::fetch_unsafe(Item &item) {
+
+  size_t h = head;
+  if (h != tail) {
+    Atomic::barrier();
+    item = arrayp[slot(h)];
+    Atomic::barrier();
+    head = next(h);
+    return true;
+  }
+  return false;
+}
+
+
+template<typename Item> inline
+size_t SpscQueue<Item>::fetch_n_unsafe(Item items[], size_t max_count) {
+
+  size_t h = head;
+  size_t n = count(h, tail);
+  if (n > max_count) n = max_count;
+  if (n > 0) {
+    Atomic::barrier();
+    for (size_t i = 0; i < n; ++i) {
+      items[i] = arrayp[slot(h)];
+      h = next(h);
+    }
+    Atomic::barrier();
+    head = h;
+  }
+  return n;
+}
+
+
+template<typename Item> inline
+bool SpscQueue<Item>::peek_unsafe(Item &item) const {
+
+  size_t h = head;
+  if (h != tail) {
+    Atomic::barrier();
+    item = arrayp[slot(h)];
+    return true;
+  }
+  return false;
+}
+
+
+template<typename Item> inline
+bool SpscQueue<Item>::skip_unsafe() {
+
+  size_t h = head;
+  if (h != tail) {
+    Atomic::barrier();
+    head = next(h);
+    return true;
+  }
+  return false;
+}
+
+
+template<typename Item> inline
+size_t SpscQueue<Item>::get_length() const {
+
+  return length;
+}
+
+
+template<typename Item> inline
+size_t SpscQueue<Item>::get_count() const {
+
+  return count(head, tail);
+}
+
+
+template<typename Item> inline
+bool SpscQueue<Item>::post(Item item) {
+
+  return post_unsafe(item);
+}
+
+
+template<typename Item> inline
+bool SpscQueue<Item>::fetch(Item &item) {
+
+  return fetch_unsafe(item);
+}
+
+
+template<typename Item> inline
+size_t SpscQueue<Item>::fetch_n(Item items[], size_t max_count) {
+
+  return fetch_n_unsafe(items, max_count);
+}
+
+
+template<typename Item> inline
+bool SpscQueue<Item>::skip() {
+
+  return skip_unsafe();
+}
+
+
+template<typename Item> inline
+SpscQueue<Item>::SpscQueue(Item array[], size_t length)
+:
+  arrayp(array),
+  length(length),
+  head(0),
+  tail(0)
+{
+  R2P_ASSERT(array != NULL);
+  R2P_ASSERT(length > 0);
+}
+
+
+} // namespace r2p
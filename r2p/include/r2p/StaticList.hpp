@@ -445,7 +445,9 @@ public:
   }
 
   const ConstIteratorUnsafe begin_unsafe() const {
-    return ConstIteratorUnsafe(get_head_unsafe());
+    return ConstIteratorUnsafe(
+      reinterpret_cast<const ConstLink *>(get_head_unsafe())
+    );
   }
 
   const ConstIteratorUnsafe end_unsafe() const {
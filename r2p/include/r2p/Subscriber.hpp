@@ -16,21 +16,27 @@ class Subscriber : public SubscriberExtBuf<MessageType> {
 
 public:
   typedef typename SubscriberExtBuf<MessageType>::Callback Callback;
+  typedef typename SubscriberExtBuf<MessageType>::OverflowPolicy
+    OverflowPolicy;
 
 private:
   MessageType msgpool_buf[QUEUE_LENGTH];
-  MessageType *queue_buf[QUEUE_LENGTH];
+  TimestampedMsgPtrQueue::Entry queue_buf[QUEUE_LENGTH];
 
 public:
-  Subscriber(Callback callback = NULL);
+  Subscriber(Callback callback = NULL,
+             OverflowPolicy policy = LocalSubscriber::DROP_NEWEST,
+             TimestampedMsgPtrQueue::Kind queue_kind =
+               TimestampedMsgPtrQueue::ARRAY);
   ~Subscriber();
 };
 
 
 template<typename MT, unsigned QL> inline
-Subscriber<MT, QL>::Subscriber(Callback callback)
+Subscriber<MT, QL>::Subscriber(Callback callback, OverflowPolicy policy,
+                               TimestampedMsgPtrQueue::Kind queue_kind)
 :
-  SubscriberExtBuf<MT>(queue_buf, QL, callback)
+  SubscriberExtBuf<MT>(queue_buf, QL, callback, policy, queue_kind)
 {}
 
 
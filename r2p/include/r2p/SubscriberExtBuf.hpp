@@ -13,6 +13,7 @@ template<typename MessageType>
 class SubscriberExtBuf : public LocalSubscriber {
 public:
   typedef bool (*Callback)(const MessageType &msg);
+  typedef LocalSubscriber::OverflowPolicy OverflowPolicy;
 
 public:
   Callback get_callback() const;
@@ -21,8 +22,12 @@ public:
   bool release(MessageType &msg);
 
 public:
-  SubscriberExtBuf(MessageType *queue_buf[], size_t queue_length,
-                   Callback callback = NULL);
+  SubscriberExtBuf(TimestampedMsgPtrQueue::Entry queue_buf[],
+                   size_t queue_length,
+                   Callback callback = NULL,
+                   OverflowPolicy policy = LocalSubscriber::DROP_NEWEST,
+                   TimestampedMsgPtrQueue::Kind queue_kind =
+                     TimestampedMsgPtrQueue::ARRAY);
   ~SubscriberExtBuf();
 };
 
@@ -62,11 +67,15 @@ bool SubscriberExtBuf<MT>::release(MT &msg) {
 
 
 template<typename MT> inline
-SubscriberExtBuf<MT>::SubscriberExtBuf(MT *queue_buf[], size_t queue_length,
-                                       Callback callback)
+SubscriberExtBuf<MT>::SubscriberExtBuf(
+  TimestampedMsgPtrQueue::Entry queue_buf[], size_t queue_length,
+  Callback callback, OverflowPolicy policy,
+  TimestampedMsgPtrQueue::Kind queue_kind
+)
 :
-  LocalSubscriber(reinterpret_cast<Message **>(queue_buf), queue_length,
-                  reinterpret_cast<LocalSubscriber::Callback>(callback))
+  LocalSubscriber(queue_buf, queue_length,
+                  reinterpret_cast<LocalSubscriber::Callback>(callback),
+                  policy, queue_kind)
 {
   static_cast_check<MT, Message>();
 }
@@ -5,23 +5,24 @@
 namespace r2p {
 
 
-class Time { // TODO: Fix infinite algebra
+// Signed 64-bit microseconds, monotonic since boot; never wraps in practice.
+// INFINITE and INFINITEN absorb finite values, and finite sums saturate to
+// them, so that deadlines computed from infinite timeouts stay infinite.
+class Time {
 public:
-  typedef int32_t Type;
+  typedef int64_t Type;
 
-  enum {
-    MIN_US =  (1 << (8 * sizeof(Type) - 1)) + 1,
-    MAX_US = ~(1 << (8 * sizeof(Type) - 1)) - 1,
+  static const Type MAX_US = 0x7FFFFFFFFFFFFFFELL;
+  static const Type MIN_US = -MAX_US;
 
-    MIN_MS = MIN_US / 1000,
-    MAX_MS = MAX_US / 1000,
+  static const Type MIN_MS = MIN_US / 1000;
+  static const Type MAX_MS = MAX_US / 1000;
 
-    MIN_S = MIN_US / 1000000,
-    MAX_S = MAX_US / 1000000,
+  static const Type MIN_S = MIN_US / 1000000;
+  static const Type MAX_S = MAX_US / 1000000;
 
-    MIN_M = MAX_US / 60000000,
-    MAX_M = MAX_US / 60000000,
-  };
+  static const Type MIN_M = MIN_US / 60000000;
+  static const Type MAX_M = MAX_US / 60000000;
 
 public:
   Type raw;
@@ -138,16 +139,14 @@ Time &Time::operator = (const Time &rhs) {
 inline
 Time &Time::operator += (const Time &rhs) {
 
-  raw += rhs.raw;
-  return *this;
+  return *this = *this + rhs;
 }
 
 
 inline
 Time &Time::operator -= (const Time &rhs) {
 
-  raw += rhs.raw;
-  return *this;
+  return *this = *this - rhs;
 }
 
 
@@ -204,7 +203,7 @@ Time Time::m(const Type minutes) {
 inline
 Time Time::hz(const double hertz) {
 
-  if (hertz < 1.0 / MAX_US) return Time(MAX_US);
+  if (hertz < 1.0 / static_cast<double>(MAX_US)) return Time(MAX_US);
   else if (hertz > 1000000.0) return Time(1);
   else return Time(static_cast<Type>(1000000.0 / hertz));
 }
@@ -255,6 +254,15 @@ bool operator <= (const Time &lhs, const Time &rhs) {
 inline
 const Time operator + (const Time &lhs, const Time &rhs) {
 
+  // Raw bounds, the Time constants may not be built yet
+  if (lhs.raw > Time::MAX_US || lhs.raw < Time::MIN_US) return lhs;
+  if (rhs.raw > Time::MAX_US || rhs.raw < Time::MIN_US) return rhs;
+  if (rhs.raw > 0 && lhs.raw > Time::MAX_US - rhs.raw) {
+    return Time(Time::MAX_US + 1);
+  }
+  if (rhs.raw < 0 && lhs.raw < Time::MIN_US - rhs.raw) {
+    return Time(Time::MIN_US - 1);
+  }
   return Time(lhs.raw + rhs.raw);
 }
 
@@ -262,7 +270,10 @@ const Time operator + (const Time &lhs, const Time &rhs) {
 inline
 const Time operator - (const Time &lhs, const Time &rhs) {
 
-  return Time(lhs.raw - rhs.raw);
+  if (lhs.raw > Time::MAX_US || lhs.raw < Time::MIN_US) return lhs;
+  if (rhs.raw > Time::MAX_US) return Time(Time::MIN_US - 1);
+  if (rhs.raw < Time::MIN_US) return Time(Time::MAX_US + 1);
+  return lhs + Time(-rhs.raw);
 }
 
 
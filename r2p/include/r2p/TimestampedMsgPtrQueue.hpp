@@ -2,6 +2,8 @@
 
 #include <r2p/common.hpp>
 #include <r2p/ArrayQueue.hpp>
+#include <r2p/SpscQueue.hpp>
+#include <r2p/MpscQueue.hpp>
 #include <r2p/Time.hpp>
 
 namespace r2p {
@@ -11,9 +13,19 @@ class Message;
 
 class TimestampedMsgPtrQueue {
 public:
+  // Queue flavor of each instance, among those built in
+  enum Kind {
+    ARRAY,  // SysLock on both sides
+    SPSC,   // Producers serialized by SysLock, lock-free consumer
+    MPSC    // Lock-free producers and consumer
+  };
+
   struct Entry {
     Message *msgp;
     Time timestamp;
+#if R2P_USE_MPSC_QUEUES
+    volatile size_t seq; // Owned by the queue, never copied
+#endif
 
     Entry &operator = (const Entry &other);
 
@@ -22,23 +34,112 @@ public:
   };
 
 private:
+#if R2P_USE_SPSC_QUEUES || R2P_USE_MPSC_QUEUES
+  union {
+    uint8_t array_buf[sizeof(ArrayQueue<Entry>)];
+#if R2P_USE_SPSC_QUEUES
+    uint8_t spsc_buf[sizeof(SpscQueue<Entry>)];
+#endif
+#if R2P_USE_MPSC_QUEUES
+    uint8_t mpsc_buf[sizeof(MpscQueue<Entry>)];
+#endif
+    void *alignp;
+  } impl;
+  const uint_least8_t kind;
+#else
   ArrayQueue<Entry> impl;
+#endif
 
 public:
+  Kind get_kind() const;
+
   size_t get_count_unsafe() const;
   bool post_unsafe(Entry &entry);
   bool fetch_unsafe(Entry &entry);
+  size_t fetch_n_unsafe(Entry entries[], size_t max_count);
+  bool peek_unsafe(Entry &entry) const;
 
   size_t get_length() const;
   size_t get_count() const;
   bool post(Entry &entry);
   bool fetch(Entry &entry);
+  size_t fetch_n(Entry entries[], size_t max_count);
+
+private:
+  ArrayQueue<Entry> &array() const;
+#if R2P_USE_SPSC_QUEUES
+  SpscQueue<Entry> &spsc() const;
+#endif
+#if R2P_USE_MPSC_QUEUES
+  MpscQueue<Entry> &mpsc() const;
+#endif
 
 public:
-  TimestampedMsgPtrQueue(Entry array[], size_t length);
+  TimestampedMsgPtrQueue(Entry array[], size_t length, Kind kind = ARRAY);
 };
 
 
+#if R2P_USE_SPSC_QUEUES || R2P_USE_MPSC_QUEUES
+
+inline
+TimestampedMsgPtrQueue::Kind TimestampedMsgPtrQueue::get_kind() const {
+
+  return static_cast<Kind>(kind);
+}
+
+
+inline
+ArrayQueue<TimestampedMsgPtrQueue::Entry> &
+TimestampedMsgPtrQueue::array() const {
+
+  return *reinterpret_cast<ArrayQueue<Entry> *>(
+    const_cast<uint8_t *>(impl.array_buf)
+  );
+}
+
+#else
+
+inline
+TimestampedMsgPtrQueue::Kind TimestampedMsgPtrQueue::get_kind() const {
+
+  return ARRAY;
+}
+
+
+inline
+ArrayQueue<TimestampedMsgPtrQueue::Entry> &
+TimestampedMsgPtrQueue::array() const {
+
+  return const_cast<ArrayQueue<Entry> &>(impl);
+}
+
+#endif // R2P_USE_SPSC_QUEUES || R2P_USE_MPSC_QUEUES
+
+
+#if R2P_USE_SPSC_QUEUES
+inline
+SpscQueue<TimestampedMsgPtrQueue::Entry> &
+TimestampedMsgPtrQueue::spsc() const {
+
+  return *reinterpret_cast<SpscQueue<Entry> *>(
+    const_cast<uint8_t *>(impl.spsc_buf)
+  );
+}
+#endif
+
+
+#if R2P_USE_MPSC_QUEUES
+inline
+MpscQueue<TimestampedMsgPtrQueue::Entry> &
+TimestampedMsgPtrQueue::mpsc() const {
+
+  return *reinterpret_cast<MpscQueue<Entry> *>(
+    const_cast<uint8_t *>(impl.mpsc_buf)
+  );
+}
+#endif
+
+
 inline
 TimestampedMsgPtrQueue::Entry &
 TimestampedMsgPtrQueue::Entry::operator = (const Entry &other) {
@@ -63,42 +164,131 @@ TimestampedMsgPtrQueue::Entry::Entry(Message *msgp,
 inline
 bool TimestampedMsgPtrQueue::post_unsafe(Entry &entry) {
 
-  return impl.post_unsafe(entry);
+#if R2P_USE_MPSC_QUEUES
+  if (kind == MPSC) return mpsc().post_unsafe(entry);
+#endif
+#if R2P_USE_SPSC_QUEUES
+  if (kind == SPSC) return spsc().post_unsafe(entry);
+#endif
+  return array().post_unsafe(entry);
 }
 
 
 inline
 bool TimestampedMsgPtrQueue::fetch_unsafe(Entry &entry) {
 
-  return impl.fetch_unsafe(entry);
+#if R2P_USE_MPSC_QUEUES
+  if (kind == MPSC) return mpsc().fetch_unsafe(entry);
+#endif
+#if R2P_USE_SPSC_QUEUES
+  if (kind == SPSC) return spsc().fetch_unsafe(entry);
+#endif
+  return array().fetch_unsafe(entry);
+}
+
+
+inline
+size_t TimestampedMsgPtrQueue::fetch_n_unsafe(Entry entries[],
+                                              size_t max_count) {
+
+#if R2P_USE_MPSC_QUEUES
+  if (kind == MPSC) return mpsc().fetch_n_unsafe(entries, max_count);
+#endif
+#if R2P_USE_SPSC_QUEUES
+  if (kind == SPSC) return spsc().fetch_n_unsafe(entries, max_count);
+#endif
+  return array().fetch_n_unsafe(entries, max_count);
+}
+
+
+inline
+bool TimestampedMsgPtrQueue::peek_unsafe(Entry &entry) const {
+
+#if R2P_USE_MPSC_QUEUES
+  if (kind == MPSC) return mpsc().peek_unsafe(entry);
+#endif
+#if R2P_USE_SPSC_QUEUES
+  if (kind == SPSC) return spsc().peek_unsafe(entry);
+#endif
+  return array().peek_unsafe(entry);
+}
+
+
+inline
+size_t TimestampedMsgPtrQueue::get_count_unsafe() const {
+
+#if R2P_USE_MPSC_QUEUES
+  if (kind == MPSC) return mpsc().get_count();
+#endif
+#if R2P_USE_SPSC_QUEUES
+  if (kind == SPSC) return spsc().get_count();
+#endif
+  return array().get_count();
 }
 
 
 inline
 size_t TimestampedMsgPtrQueue::get_length() const {
 
-  return impl.get_length();
+#if R2P_USE_MPSC_QUEUES
+  if (kind == MPSC) return mpsc().get_length();
+#endif
+#if R2P_USE_SPSC_QUEUES
+  if (kind == SPSC) return spsc().get_length();
+#endif
+  return array().get_length();
 }
 
 
 inline
 size_t TimestampedMsgPtrQueue::get_count() const {
 
-  return impl.get_count();
+#if R2P_USE_MPSC_QUEUES
+  if (kind == MPSC) return mpsc().get_count();
+#endif
+#if R2P_USE_SPSC_QUEUES
+  if (kind == SPSC) return spsc().get_count();
+#endif
+  return array().get_count();
 }
 
 
 inline
 bool TimestampedMsgPtrQueue::post(Entry &entry) {
 
-  return impl.post(entry);
+#if R2P_USE_MPSC_QUEUES
+  if (kind == MPSC) return mpsc().post(entry);
+#endif
+#if R2P_USE_SPSC_QUEUES
+  if (kind == SPSC) return spsc().post(entry);
+#endif
+  return array().post(entry);
 }
 
 
 inline
 bool TimestampedMsgPtrQueue::fetch(Entry &entry) {
 
-  return impl.fetch(entry);
+#if R2P_USE_MPSC_QUEUES
+  if (kind == MPSC) return mpsc().fetch(entry);
+#endif
+#if R2P_USE_SPSC_QUEUES
+  if (kind == SPSC) return spsc().fetch(entry);
+#endif
+  return array().fetch(entry);
+}
+
+
+inline
+size_t TimestampedMsgPtrQueue::fetch_n(Entry entries[], size_t max_count) {
+
+#if R2P_USE_MPSC_QUEUES
+  if (kind == MPSC) return mpsc().fetch_n(entries, max_count);
+#endif
+#if R2P_USE_SPSC_QUEUES
+  if (kind == SPSC) return spsc().fetch_n(entries, max_count);
+#endif
+  return array().fetch_n(entries, max_count);
 }
 
 
@@ -2,9 +2,17 @@
 
 #include <r2p/common.hpp>
 #include <r2p/NamingTraits.hpp>
+#if R2P_USE_SHARED_MSG_POOL
+#include <r2p/MessageSlab.hpp>
+#else
 #include <r2p/impl/MemoryPool_.hpp>
+#endif
 #include <r2p/StaticList.hpp>
+#include <r2p/Semaphore.hpp>
 #include <r2p/Time.hpp>
+#if R2P_USE_TRAFFIC_COUNTERS
+#include <r2p/TrafficCounters.hpp>
+#endif
 
 namespace r2p {
 
@@ -14,6 +22,7 @@ namespace r2p {
 
 
 class Message;
+class BaseSubscriber;
 class LocalPublisher;
 class LocalSubscriber;
 class RemotePublisher;
@@ -25,8 +34,18 @@ class Topic : private Uncopyable {
 
 private:
   const char *const namep;
+  const uint32_t name_hash;
   Time publish_timeout;
+#if R2P_USE_SHARED_MSG_POOL
+  const size_t type_size;
+  uint_least8_t slab_class; // Claimed by the first extend_pool()
+  size_t pool_quota;
+#else
   MemoryPool_ msg_pool;
+  Semaphore alloc_sem;
+  size_t num_alloc_waiters;
+#endif
+  size_t num_allocated;
   size_t num_local_publishers;
   size_t num_remote_publishers;
   StaticList<LocalSubscriber> local_subscribers;
@@ -35,16 +54,29 @@ private:
 #if R2P_USE_BRIDGE_MODE
   bool forwarding;
 #endif
+#if R2P_USE_TRAFFIC_COUNTERS
+  TrafficCounters counters;
+#endif
 
   StaticList<Topic>::Link by_middleware;
 
 public:
   const char *get_name() const;
+  uint32_t get_name_hash() const;
   const Time &get_publish_timeout() const;
   size_t get_type_size() const;
   size_t get_payload_size() const;
   size_t get_max_queue_length() const;
   bool is_forwarding() const;
+  size_t get_num_allocated() const;
+#if R2P_USE_SHARED_MSG_POOL
+  size_t get_pool_quota() const;
+  void set_pool_quota(size_t quota);
+#endif
+#if R2P_USE_TRAFFIC_COUNTERS
+  const TrafficCounters &get_counters() const;
+  void count_publish_unsafe();
+#endif
 
   bool has_local_publishers() const;
   bool has_remote_publishers() const;
@@ -57,6 +89,8 @@ public:
 
   const Time compute_deadline_unsafe(const Time &timestamp) const;
   const Time compute_deadline_unsafe() const;
+  const Time compute_slack_unsafe(const Time &timestamp,
+                                  const Time &now) const;
   Message *alloc_unsafe();
   template<typename MessageType> bool alloc_unsafe(MessageType *&msgp);
   bool release_unsafe(Message &msg);
@@ -69,7 +103,10 @@ public:
   const Time compute_deadline(const Time &timestamp) const;
   const Time compute_deadline() const;
   Message *alloc();
+  Message *alloc(const Time &timeout);
   template<typename MessageType> bool alloc(MessageType *&msgp);
+  template<typename MessageType> bool alloc(MessageType *&msgp,
+                                            const Time &timeout);
   bool release(Message &msg);
   void free(Message &msg);
   bool notify_locals(Message &msg, const Time &timestamp);
@@ -83,6 +120,8 @@ public:
   void subscribe(RemoteSubscriber &sub, size_t queue_length);
 
 private:
+  void count_delivery(BaseSubscriber &sub, bool delivered);
+  bool requires_patching(const Message &msg) const;
   void patch_pubsub_msg(Message &msg, Transport &transport) const;
 
 public:
@@ -134,6 +173,13 @@ const char *Topic::get_name() const {
 }
 
 
+inline
+uint32_t Topic::get_name_hash() const {
+
+  return name_hash;
+}
+
+
 inline
 const Time &Topic::get_publish_timeout() const {
 
@@ -144,17 +190,50 @@ const Time &Topic::get_publish_timeout() const {
 inline
 size_t Topic::get_type_size() const {
 
+#if R2P_USE_SHARED_MSG_POOL
+  return type_size;
+#else
   return msg_pool.get_item_size();
+#endif
 }
 
 
 inline
 size_t Topic::get_payload_size() const {
 
-  return Message::get_payload_size(msg_pool.get_item_size());
+  return Message::get_payload_size(get_type_size());
 }
 
 
+inline
+size_t Topic::get_num_allocated() const {
+
+  return num_allocated;
+}
+
+
+#if R2P_USE_SHARED_MSG_POOL
+
+inline
+size_t Topic::get_pool_quota() const {
+
+  return pool_quota;
+}
+
+
+inline
+void Topic::set_pool_quota(size_t quota) {
+
+  const size_t index = MessageSlab::instance.find_class(type_size);
+  SysLock::acquire();
+  slab_class = static_cast<uint_least8_t>(index);
+  pool_quota = quota;
+  SysLock::release();
+}
+
+#endif // R2P_USE_SHARED_MSG_POOL
+
+
 inline
 size_t Topic::get_max_queue_length() const {
 
@@ -173,6 +252,22 @@ bool Topic::is_forwarding() const {
 }
 
 
+#if R2P_USE_TRAFFIC_COUNTERS
+inline
+const TrafficCounters &Topic::get_counters() const {
+
+  return counters;
+}
+
+
+inline
+void Topic::count_publish_unsafe() {
+
+  ++counters.publishes;
+}
+#endif
+
+
 inline
 bool Topic::has_local_publishers() const {
 
@@ -246,14 +341,40 @@ const Time Topic::compute_deadline_unsafe() const {
 }
 
 
+inline
+const Time Topic::compute_slack_unsafe(const Time &timestamp,
+                                       const Time &now) const {
+
+  // Relative to the timestamp, so that clock wrap-around does not matter
+  if (publish_timeout == Time::INFINITE) return Time::INFINITE;
+  return publish_timeout - (now - timestamp);
+}
+
+
 inline
 Message *Topic::alloc_unsafe() {
 
+#if R2P_USE_SHARED_MSG_POOL
+  register Message *msgp = NULL;
+  if (num_allocated < pool_quota) {
+    msgp = reinterpret_cast<Message *>(
+      MessageSlab::instance.alloc_unsafe(slab_class)
+    );
+  }
+#else
   register Message *msgp = reinterpret_cast<Message *>(msg_pool.alloc_unsafe());
+#endif
   if (msgp != NULL) {
+    ++num_allocated;
+#if R2P_USE_TRAFFIC_COUNTERS
+    counters.update_pool_usage(num_allocated);
+#endif
     msgp->reset_unsafe();
     return msgp;
   }
+#if R2P_USE_TRAFFIC_COUNTERS
+  ++counters.alloc_failures;
+#endif
   return NULL;
 }
 
@@ -280,7 +401,16 @@ bool Topic::release_unsafe(Message &msg) {
 inline
 void Topic::free_unsafe(Message &msg) {
 
+  R2P_ASSERT(num_allocated > 0);
+  --num_allocated;
+#if R2P_USE_SHARED_MSG_POOL
+  MessageSlab::instance.free_unsafe(slab_class, reinterpret_cast<void *>(&msg));
+#else
   msg_pool.free_unsafe(reinterpret_cast<void *>(&msg));
+  if (num_alloc_waiters > 0) {
+    alloc_sem.signal_unsafe();
+  }
+#endif
 }
 
 
@@ -309,6 +439,14 @@ bool Topic::alloc(MessageType *&msgp) {
 }
 
 
+template<typename MessageType> inline
+bool Topic::alloc(MessageType *&msgp, const Time &timeout) {
+
+  static_cast_check<MessageType, Message>();
+  return (msgp = reinterpret_cast<MessageType *>(alloc(timeout))) != NULL;
+}
+
+
 inline
 bool Topic::release(Message &msg) {
 
@@ -322,14 +460,26 @@ bool Topic::release(Message &msg) {
 inline
 void Topic::free(Message &msg) {
 
-  msg_pool.free(reinterpret_cast<void *>(&msg));
+  SysLock::acquire();
+  free_unsafe(msg);
+  SysLock::release();
 }
 
 
 inline
 void Topic::extend_pool(Message array[], size_t arraylen) {
 
+#if R2P_USE_SHARED_MSG_POOL
+  const size_t index = MessageSlab::instance.find_class(type_size);
+  const size_t length =
+    MessageSlab::instance.grow(index, array, arraylen * type_size);
+  SysLock::acquire();
+  slab_class = static_cast<uint_least8_t>(index);
+  pool_quota += length;
+  SysLock::release();
+#else
   msg_pool.extend(array, arraylen);
+#endif
 }
 
 
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <r2p/common.hpp>
+
+namespace r2p {
+
+class Topic;
+
+
+// Fixed-capacity open-addressing hash table of topics, indexed by name.
+// It is filled up to 3/4 of its length, so that probe sequences stay short;
+// size it at about twice the expected number of topics.
+class TopicIndex : private Uncopyable {
+private:
+  Topic **tablep;
+  size_t length;
+  size_t capacity;
+  size_t count;
+  bool complete;
+
+public:
+  size_t get_length() const;
+  size_t get_capacity() const;
+  size_t get_count() const;
+  bool is_complete() const;
+
+  bool insert(Topic &topic);
+  Topic *find(const char *namep) const;
+
+public:
+  TopicIndex(Topic *table[] = NULL, size_t length = 0);
+
+public:
+  static uint32_t hash(const char *namep);
+};
+
+
+inline
+size_t TopicIndex::get_length() const {
+
+  return length;
+}
+
+
+inline
+size_t TopicIndex::get_capacity() const {
+
+  return capacity;
+}
+
+
+inline
+size_t TopicIndex::get_count() const {
+
+  return count;
+}
+
+
+inline
+bool TopicIndex::is_complete() const {
+
+  return complete;
+}
+
+
+} // namespace r2p
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <r2p/common.hpp>
+
+namespace r2p {
+
+
+// Traffic statistics of a topic or subscriber, updated under SysLock
+struct TrafficCounters {
+  uint32_t  publishes;
+  uint32_t  deliveries;
+  uint32_t  queue_drops;
+  uint32_t  alloc_failures;
+  uint16_t  max_queue_depth;
+  uint16_t  max_pool_usage;
+
+  void update_queue_depth(size_t depth);
+  void update_pool_usage(size_t num_allocated);
+  void reset();
+
+  TrafficCounters();
+};
+
+
+inline
+void TrafficCounters::update_queue_depth(size_t depth) {
+
+  if (depth > max_queue_depth) {
+    max_queue_depth = static_cast<uint16_t>(depth);
+  }
+}
+
+
+inline
+void TrafficCounters::update_pool_usage(size_t num_allocated) {
+
+  if (num_allocated > max_pool_usage) {
+    max_pool_usage = static_cast<uint16_t>(num_allocated);
+  }
+}
+
+
+inline
+void TrafficCounters::reset() {
+
+  publishes = 0;
+  deliveries = 0;
+  queue_drops = 0;
+  alloc_failures = 0;
+  max_queue_depth = 0;
+  max_pool_usage = 0;
+}
+
+
+inline
+TrafficCounters::TrafficCounters() {
+
+  reset();
+}
+
+
+} // namespace r2p
@@ -4,10 +4,18 @@
 #include <r2p/StaticList.hpp>
 #include <r2p/TimestampedMsgPtrQueue.hpp>
 #include <r2p/Mutex.hpp>
+#include <r2p/Semaphore.hpp>
 #include <r2p/NamingTraits.hpp>
 
 namespace r2p {
 
+// Messages of topics without a publish timeout, management included, are
+// sent as if they were due this long after their timestamp, so that a
+// steady flow with deadlines cannot starve them. They never expire.
+#if !defined(R2P_TRANSPORT_UNTIMED_TX_DELAY_MS) || defined(__DOXYGEN__)
+#define R2P_TRANSPORT_UNTIMED_TX_DELAY_MS   100
+#endif
+
 class Message;
 class Time;
 class Topic;
@@ -25,6 +33,15 @@ protected:
   Mutex publishers_lock;
   Mutex subscribers_lock;
 
+private:
+  // Transmission scheduler state, guarded by SysLock
+  RemoteSubscriber *tx_rootp; // Earliest queue head deadline on top
+  Semaphore tx_sem;
+  bool tx_waiting;
+  size_t num_tx_expired;
+  Transport *tx_flush_nextp;
+  bool tx_flush_linked;
+
 private:
   mutable StaticList<Transport>::Link by_middleware;
 
@@ -32,9 +49,14 @@ public:
   const char *get_name() const;
   const StaticList<RemotePublisher> &get_publishers() const;
   const StaticList<RemoteSubscriber> &get_subscribers() const;
+  size_t get_num_tx_expired() const;
 
   virtual void fill_raw_params(const Topic &topic, uint8_t raw_params[]);
 
+  void notify_tx_unsafe(RemoteSubscriber &sub);
+  virtual void flush_tx_unsafe();
+  void link_tx_flush_unsafe(Transport *&headp);
+
 protected:
   bool touch_publisher(Topic &topic, const uint8_t raw_params[] = NULL);
   bool touch_subscriber(Topic &topic, size_t queue_length,
@@ -61,18 +83,33 @@ protected:
   virtual RemotePublisher *create_publisher(Topic &topic,
                                             const uint8_t raw_params[] = NULL)
                                             const = 0;
+  virtual void refresh_publisher(RemotePublisher &pub,
+                                 const uint8_t raw_params[] = NULL);
   virtual RemoteSubscriber *create_subscriber(
     Topic &topic,
     TimestampedMsgPtrQueue::Entry queue_buf[],
     size_t queue_length
   ) const = 0;
 
+  RemoteSubscriber *peek_tx_unsafe();
+  RemoteSubscriber *fetch_tx_unsafe(Message *&msgp, Time &deadline);
+  RemoteSubscriber *fetch_tx(Message *&msgp, Time &deadline);
+
+private:
+  void schedule_tx_unsafe(RemoteSubscriber &sub);
+  void unschedule_tx_unsafe();
+
 protected:
   Transport(const char *namep);
   virtual ~Transport() = 0;
 
 public:
   static bool has_name(const Transport &transport, const char *namep);
+  static void flush_tx_list_unsafe(Transport *headp);
+
+private:
+  static RemoteSubscriber *merge_tx(RemoteSubscriber *ap,
+                                    RemoteSubscriber *bp);
 };
 
 
@@ -104,6 +141,36 @@ const StaticList<RemoteSubscriber> &Transport::get_subscribers() const {
 }
 
 
+inline
+size_t Transport::get_num_tx_expired() const {
+
+  return num_tx_expired;
+}
+
+
+inline
+void Transport::notify_tx_unsafe(RemoteSubscriber &sub) {
+
+  schedule_tx_unsafe(sub);
+  if (tx_waiting) {
+    tx_waiting = false;
+    tx_sem.signal_unsafe();
+  }
+}
+
+
+// Links the transport once to the list flushed by flush_tx_list_unsafe()
+inline
+void Transport::link_tx_flush_unsafe(Transport *&headp) {
+
+  if (!tx_flush_linked) {
+    tx_flush_linked = true;
+    tx_flush_nextp = headp;
+    headp = this;
+  }
+}
+
+
 template<typename MessageType> inline
 bool Transport::advertise(RemotePublisher &pub, const char *namep,
                           const Time &publish_timeout) {
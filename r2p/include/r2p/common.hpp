@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstring>
+#include <stdint.h>
 
 #include <r2p/Uncopyable.hpp>
 #include <r2p/Utils.hpp>
@@ -26,6 +27,26 @@ namespace r2p {
 #define R2P_USE_BRIDGE_MODE 0
 #endif
 
+#if !defined(R2P_USE_SPSC_QUEUES) || defined(__DOXYGEN__)
+#define R2P_USE_SPSC_QUEUES 0
+#endif
+
+#if !defined(R2P_USE_MPSC_QUEUES) || defined(__DOXYGEN__)
+#define R2P_USE_MPSC_QUEUES 0
+#endif
+
+#if !defined(R2P_USE_LATENCY_HISTOGRAMS) || defined(__DOXYGEN__)
+#define R2P_USE_LATENCY_HISTOGRAMS 0
+#endif
+
+#if !defined(R2P_USE_TRAFFIC_COUNTERS) || defined(__DOXYGEN__)
+#define R2P_USE_TRAFFIC_COUNTERS 0
+#endif
+
+#if !defined(R2P_USE_SHARED_MSG_POOL) || defined(__DOXYGEN__)
+#define R2P_USE_SHARED_MSG_POOL 0
+#endif
+
 
 template<typename Test, typename Base> R2P_FORCE_INLINE
 void static_cast_check () {
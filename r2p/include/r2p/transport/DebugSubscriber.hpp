@@ -3,13 +3,10 @@
 #include <r2p/common.hpp>
 #include <r2p/RemoteSubscriber.hpp>
 #include <r2p/TimestampedMsgPtrQueue.hpp>
-#include <r2p/StaticList.hpp>
-#include <r2p/BaseSubscriberQueue.hpp>
 #include <ch.h>
 
 namespace r2p {
 
-class Message;
 class DebugTransport;
 
 
@@ -17,46 +14,25 @@ class DebugSubscriber : public RemoteSubscriber {
   friend class DebugTransport;
 
 private:
-  TimestampedMsgPtrQueue tmsgp_queue;
-
-private:
-  mutable BaseSubscriberQueue::Link by_transport_notify;
+  uint8_t topic_id;
 
 public:
-  size_t get_queue_length() const;
-  size_t get_queue_count() const;
-
-  bool fetch_unsafe(Message *&msgp, Time &timestamp);
-  bool notify_unsafe(Message &msg, const Time &timestamp);
-
-  bool fetch(Message *&msgp, Time &timestamp);
-  bool notify(Message &msg, const Time &timestamp);
+  uint8_t get_topic_id() const;
 
 public:
   DebugSubscriber(DebugTransport &transport,
                   TimestampedMsgPtrQueue::Entry queue_buf[],
-                  size_t queue_length);
+                  size_t queue_length,
+                  TimestampedMsgPtrQueue::Kind queue_kind =
+                    TimestampedMsgPtrQueue::ARRAY);
   ~DebugSubscriber();
 };
 
 
 inline
-bool DebugSubscriber::notify(Message &msg, const Time &timestamp) {
-
-  SysLock::acquire();
-  bool success = notify_unsafe(msg, timestamp);
-  SysLock::release();
-  return success;
-}
-
-
-inline
-bool DebugSubscriber::fetch(Message *&msgp, Time &timestamp) {
+uint8_t DebugSubscriber::get_topic_id() const {
 
-  SysLock::acquire();
-  bool success = fetch_unsafe(msgp, timestamp);
-  SysLock::release();
-  return success;
+  return topic_id;
 }
 
 
@@ -2,13 +2,13 @@
 
 #include <r2p/common.hpp>
 #include <r2p/Transport.hpp>
-#include <r2p/BaseSubscriberQueue.hpp>
 #include <r2p/TimestampedMsgPtrQueue.hpp>
 #include <r2p/Mutex.hpp>
 #include <r2p/MgmtMsg.hpp>
 #include <r2p/Bootloader.hpp>
 #include <r2p/BootMsg.hpp>
 #include <r2p/Semaphore.hpp>
+#include <r2p/LinkChecksummer.hpp>
 
 #include <ch.h>
 #include <io_channel.h>
@@ -19,8 +19,54 @@
 
 namespace r2p {
 
+#if !defined(R2P_DEBUGTRANSPORT_MAX_TOPIC_IDS) || defined(__DOXYGEN__)
+#define R2P_DEBUGTRANSPORT_MAX_TOPIC_IDS    16
+#endif
+
+#if !defined(R2P_DEBUGTRANSPORT_TX_BUFFER_LENGTH) || defined(__DOXYGEN__)
+#define R2P_DEBUGTRANSPORT_TX_BUFFER_LENGTH     128
+#endif
+
+#if !defined(R2P_DEBUGTRANSPORT_RX_BUFFER_LENGTH) || defined(__DOXYGEN__)
+#define R2P_DEBUGTRANSPORT_RX_BUFFER_LENGTH     64
+#endif
+
+#if !defined(R2P_DEBUGTRANSPORT_BINARY_MAX_PAYLOAD) || defined(__DOXYGEN__)
+#define R2P_DEBUGTRANSPORT_BINARY_MAX_PAYLOAD   64
+#endif
+
 
 class DebugTransport : public Transport {
+public:
+  enum { MAX_TOPIC_IDS = R2P_DEBUGTRANSPORT_MAX_TOPIC_IDS };
+  enum { NO_TOPIC_ID = 0xFF };
+  enum { BINARY_MAX_PAYLOAD = R2P_DEBUGTRANSPORT_BINARY_MAX_PAYLOAD };
+  enum { TX_BUFFER_LENGTH = R2P_DEBUGTRANSPORT_TX_BUFFER_LENGTH };
+  enum { RX_BUFFER_LENGTH = R2P_DEBUGTRANSPORT_RX_BUFFER_LENGTH };
+
+  // Layout of MgmtMsg::PubSub::raw_params for this transport
+  enum {
+    RAW_MAGIC0_OFFSET   = 0,
+    RAW_MAGIC1_OFFSET   = 1,
+    RAW_TOPIC_ID_OFFSET = 2,
+    RAW_FLAGS_OFFSET    = 3,
+
+    RAW_MAGIC0          = 'I',
+    RAW_MAGIC1          = 'D',
+
+    RAW_FLAG_BINARY     = 1 << 0,
+  };
+
+private:
+  // Kind, deadline, name length and name, payload length and data, checksum.
+  // The deadline is the low 32 bits of the microseconds (a ~71 minute wrap,
+  // INFINITE reads as 0xFFFFFFFF); receivers skip it.
+  enum {
+    BINARY_FRAME_LENGTH = 1 + sizeof(uint32_t) +
+                          1 + NamingTraits<Topic>::MAX_LENGTH +
+                          1 + BINARY_MAX_PAYLOAD + sizeof(uint32_t)
+  };
+
 private:
   Thread *rx_threadp;
   Thread *tx_threadp;
@@ -28,11 +74,37 @@ private:
   BaseChannel *channelp;
   char *namebufp;
 
-  Semaphore subp_sem;
-  BaseSubscriberQueue subp_queue;
-
   Mutex send_lock;
 
+  // Outgoing bytes, written to the channel in one go; guarded by send_lock.
+  // The frame being packed starts at txframe, unless its head is written.
+  uint8_t txbuf[TX_BUFFER_LENGTH];
+  size_t txlen;
+  size_t txframe;
+  bool txframe_written;
+
+  // Incoming bytes read in bulk, parsed from [rxhead, rxtail); RX thread only
+  uint8_t rxbuf[RX_BUFFER_LENGTH];
+  size_t rxhead;
+  size_t rxtail;
+
+  // Frame check, must match the one configured on the other side
+  const uint8_t checksum_algorithm;
+
+  // Compact topic IDs assigned by this side to its remote subscribers
+  uint8_t next_topic_id;
+  // Remote publishers indexed by the topic IDs assigned by the peer
+  RemotePublisher *id_publishers[MAX_TOPIC_IDS];
+  // Set once the peer shows it can decode compact topic IDs
+  bool peer_topic_ids;
+
+  // Binary COBS framing, opt-in: used once both sides have announced it
+  bool binary_enabled;
+  bool peer_binary;
+  uint8_t frame_buf[BINARY_FRAME_LENGTH];
+  uint8_t cobs_left;
+  bool cobs_zero;
+
   enum { MGMT_BUFFER_LENGTH = 4 };
   TimestampedMsgPtrQueue::Entry mgmt_msgqueue_buf[MGMT_BUFFER_LENGTH];
   MgmtMsg mgmt_msgbuf[MGMT_BUFFER_LENGTH];
@@ -48,6 +120,10 @@ private:
 #endif
 
 public:
+  LinkChecksummer::Algorithm get_checksum_algorithm() const;
+  bool is_binary_enabled() const;
+  void set_binary_enabled(bool enabled);
+
   bool send_stop();
   bool send_reboot();
   bool send_bootload();
@@ -57,11 +133,13 @@ public:
                   void *tx_stackp, size_t tx_stacklen,
                   Thread::Priority tx_priority);
 
-  void notify_first_sub_unsafe(const DebugSubscriber &sub);
+  void fill_raw_params(const Topic &topic, uint8_t raw_params[]);
 
 private:
   RemotePublisher *create_publisher(Topic &topic,
                                     const uint8_t raw_params[] = NULL) const;
+  void refresh_publisher(RemotePublisher &pub,
+                         const uint8_t raw_params[] = NULL);
   RemoteSubscriber *create_subscriber(
     Topic &topic,
     TimestampedMsgPtrQueue::Entry queue_buf[],
@@ -72,6 +150,13 @@ private:
   bool spin_rx();
 
 private:
+  bool put_tx(uint8_t byte, systime_t timeout = TIME_INFINITE);
+  bool write_tx(const uint8_t *chunkp, size_t length,
+                systime_t timeout = TIME_INFINITE);
+  bool flush_tx(systime_t timeout = TIME_INFINITE);
+  bool fill_rx(systime_t timeout = TIME_INFINITE);
+  msg_t get_rx(systime_t timeout = TIME_INFINITE);
+  bool skip_to_frame_start(char &start, systime_t timeout = TIME_INFINITE);
   bool send_char(char c, systime_t timeout = TIME_INFINITE);
   bool expect_char(char c, systime_t timeout = TIME_INFINITE);
   bool skip_after_char(char c, systime_t timeout = TIME_INFINITE);
@@ -98,10 +183,28 @@ private:
   bool recv_value(T &value, systime_t timeout = TIME_INFINITE);
   bool send_msg(const Message &msg, size_t msg_size, const char *topicp,
                 const Time &deadline);
+  bool send_msg(const Message &msg, size_t msg_size, uint8_t topic_id,
+                const Time &deadline);
+  bool send_msg_binary(const Message &msg, size_t msg_size,
+                       const char *topicp, uint8_t topic_id,
+                       const Time &deadline);
+  bool send_frame(const uint8_t *framep, size_t length,
+                  systime_t timeout = TIME_INFINITE);
+  bool begin_cobs(systime_t timeout = TIME_INFINITE);
+  bool recv_cobs(void *chunkp, size_t length,
+                 systime_t timeout = TIME_INFINITE);
+  bool end_cobs(systime_t timeout = TIME_INFINITE);
+  bool recv_field(void *valuep, size_t length, bool binary);
+  bool expect_separator(bool binary);
+  void map_topic_id(RemotePublisher &pub, const uint8_t raw_params[]);
+  void check_peer_params(const MgmtMsg &msg);
   bool send_signal_msg(char id);
+  bool send_checksum(const LinkChecksummer &cs);
 
 public:
-  DebugTransport(const char *namep, BaseChannel *channelp, char namebuf[]);
+  DebugTransport(const char *namep, BaseChannel *channelp, char namebuf[],
+                 LinkChecksummer::Algorithm checksum_algorithm =
+                   LinkChecksummer::SUM8);
   ~DebugTransport();
 
 private:
@@ -111,10 +214,23 @@ private:
 
 
 inline
-void DebugTransport::notify_first_sub_unsafe(const DebugSubscriber &sub) {
+LinkChecksummer::Algorithm DebugTransport::get_checksum_algorithm() const {
+
+  return static_cast<LinkChecksummer::Algorithm>(checksum_algorithm);
+}
+
+
+inline
+bool DebugTransport::is_binary_enabled() const {
 
-  subp_queue.post_unsafe(sub.by_transport_notify);
-  subp_sem.signal_unsafe();
+  return binary_enabled;
+}
+
+
+inline
+void DebugTransport::set_binary_enabled(bool enabled) {
+
+  binary_enabled = enabled;
 }
 
 
@@ -124,8 +240,20 @@ RemotePublisher *DebugTransport::create_publisher(Topic &topic,
 const {
 
   (void)topic;
-  (void)raw_params;
-  return new DebugPublisher(*const_cast<DebugTransport *>(this));
+  DebugTransport &self = *const_cast<DebugTransport *>(this);
+  DebugPublisher *pubp = new DebugPublisher(self);
+  if (pubp != NULL) {
+    self.map_topic_id(*pubp, raw_params);
+  }
+  return pubp;
+}
+
+
+inline
+void DebugTransport::refresh_publisher(RemotePublisher &pub,
+                                       const uint8_t raw_params[]) {
+
+  map_topic_id(pub, raw_params);
 }
 
 
@@ -136,29 +264,50 @@ RemoteSubscriber *DebugTransport::create_subscriber(
   size_t queue_length) const {
 
   (void)topic;
-  return new DebugSubscriber(*const_cast<DebugTransport *>(this),
-                             queue_buf, queue_length);
+  DebugTransport &self = *const_cast<DebugTransport *>(this);
+  DebugSubscriber *subp = new DebugSubscriber(self, queue_buf, queue_length);
+  if (subp != NULL && self.next_topic_id < MAX_TOPIC_IDS) {
+    subp->topic_id = self.next_topic_id++;
+  }
+  return subp;
+}
+
+
+inline
+bool DebugTransport::put_tx(uint8_t byte, systime_t timeout) {
+
+  if (txlen >= TX_BUFFER_LENGTH && !flush_tx(timeout)) return false;
+  txbuf[txlen++] = byte;
+  return true;
+}
+
+
+inline
+msg_t DebugTransport::get_rx(systime_t timeout) {
+
+  if (rxhead >= rxtail && !fill_rx(timeout)) return Q_TIMEOUT;
+  return rxbuf[rxhead++];
 }
 
 
 inline
 bool DebugTransport::send_char(char c, systime_t timeout) {
 
-  return chnPutTimeout(channelp, c, timeout) == Q_OK;
+  return put_tx(static_cast<uint8_t>(c), timeout);
 }
 
 
 inline
 bool DebugTransport::expect_char(char c, systime_t timeout) {
 
-  return chnGetTimeout(channelp, timeout) == c;
+  return get_rx(timeout) == c;
 }
 
 
 inline
 bool DebugTransport::recv_char(char &c, systime_t timeout) {
 
-  register msg_t value = chnGetTimeout(channelp, timeout);
+  register msg_t value = get_rx(timeout);
   if ((value & ~0xFF) == 0) {
     c = static_cast<char>(value);
     return true;
@@ -175,9 +324,7 @@ bool DebugTransport::send_byte(uint8_t byte, systime_t timeout) {
     '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
   };
 
-  if (chnPutTimeout(channelp, hex[byte >> 4], timeout) != Q_OK) return false;
-  if (chnPutTimeout(channelp, hex[byte & 15], timeout) != Q_OK) return false;
-  return true;
+  return put_tx(hex[byte >> 4], timeout) && put_tx(hex[byte & 15], timeout);
 }
 
 
@@ -4,9 +4,9 @@
 
 #include <r2p/common.hpp>
 #include <r2p/RemoteSubscriber.hpp>
+#include <r2p/Transport.hpp>
 #include <r2p/TimestampedMsgPtrQueue.hpp>
 #include <r2p/StaticList.hpp>
-#include <r2p/BaseSubscriberQueue.hpp>
 #include <ch.h>
 
 #include "rtcan.h"
@@ -24,11 +24,7 @@ private:
   rtcan_id_t rtcan_id;
 
 public:
-  bool fetch_unsafe(Message *&msgp, Time &timestamp);
-  bool notify_unsafe(Message &msg, const Time &timestamp);
-  bool fetch(Message *&msgp, Time &timestamp);
   bool notify(Message &msg, const Time &timestamp);
-  size_t get_queue_length() const;
 
 public:
   RTCANSubscriber(RTCANTransport &transport,
@@ -40,18 +36,12 @@ public:
 inline
 bool RTCANSubscriber::notify(Message &msg, const Time &timestamp) {
 
+  // The caller already holds the reference, the driver can have it
   SysLock::acquire();
   bool success = notify_unsafe(msg, timestamp);
-  SysLock::release();
-  return success;
-}
-
-
-inline
-bool RTCANSubscriber::fetch(Message *&msgp, Time &timestamp) {
-
-  SysLock::acquire();
-  bool success = fetch_unsafe(msgp, timestamp);
+  if (success) {
+    get_transport()->flush_tx_unsafe();
+  }
   SysLock::release();
   return success;
 }
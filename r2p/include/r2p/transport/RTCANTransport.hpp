@@ -2,7 +2,6 @@
 
 #include <r2p/common.hpp>
 #include <r2p/Transport.hpp>
-#include <r2p/BaseSubscriberQueue.hpp>
 #include <r2p/TimestampedMsgPtrQueue.hpp>
 #include <r2p/Mutex.hpp>
 #include <r2p/MgmtMsg.hpp>
@@ -17,33 +16,104 @@
 
 namespace r2p {
 
+#if !defined(R2P_RTCAN_ID_MIN) || defined(__DOXYGEN__)
+#define R2P_RTCAN_ID_MIN            0x01
+#endif
+
+#if !defined(R2P_RTCAN_ID_MAX) || defined(__DOXYGEN__)
+#define R2P_RTCAN_ID_MAX            0xFE
+#endif
+
+#if !defined(R2P_RTCAN_NUM_PRIORITIES) || defined(__DOXYGEN__)
+#define R2P_RTCAN_NUM_PRIORITIES    8
+#endif
+
+#if !defined(R2P_RTCAN_MAX_ASSIGNMENTS) || defined(__DOXYGEN__)
+#define R2P_RTCAN_MAX_ASSIGNMENTS   32
+#endif
+
+#if !defined(R2P_RTCAN_MAX_PRIORITY_OVERRIDES) || defined(__DOXYGEN__)
+#define R2P_RTCAN_MAX_PRIORITY_OVERRIDES    4
+#endif
+
+#if !defined(R2P_RTCAN_TX_TIMEOUT_MS) || defined(__DOXYGEN__)
+#define R2P_RTCAN_TX_TIMEOUT_MS     50
+#endif
+
 class Message;
 
+// The upper byte of a CAN ID is the slot of the topic, the lower one the
+// node; slots are allocated in [ID_MIN, ID_MAX], lower ones (winning the
+// bus arbitration) to topics with tighter publish timeouts. When two nodes
+// pick the same slot for different topics, the topic with the lower name
+// hash moves and is advertised again. Topics whose publishers are elsewhere
+// (e.g. behind a bridge) can be given a fixed priority instead.
 class RTCANTransport : public Transport {
+public:
+  enum { NO_SLOT = 0, ID_MIN = R2P_RTCAN_ID_MIN, ID_MAX = R2P_RTCAN_ID_MAX };
+  enum { NUM_PRIORITIES = R2P_RTCAN_NUM_PRIORITIES };
+  enum { MAX_ASSIGNMENTS = R2P_RTCAN_MAX_ASSIGNMENTS };
+  enum { MAX_PRIORITY_OVERRIDES = R2P_RTCAN_MAX_PRIORITY_OVERRIDES };
+  enum { TX_TIMEOUT_MS = R2P_RTCAN_TX_TIMEOUT_MS };
+
+  // Layout of MgmtMsg::PubSub::raw_params for this transport
+  enum {
+    RAW_ID_OFFSET       = 0,
+    RAW_MAGIC0_OFFSET   = sizeof(rtcan_id_t),
+    RAW_MAGIC1_OFFSET   = sizeof(rtcan_id_t) + 1,
+
+    RAW_MAGIC0          = 'C',
+    RAW_MAGIC1          = 'N',
+  };
+
+private:
+  struct Assignment {
+    char topic[NamingTraits<Topic>::MAX_LENGTH];
+    const Topic *topicp; // Only if sent by this node
+    uint8_t slot;
+  };
+
+  struct PriorityOverride {
+    char topic[NamingTraits<Topic>::MAX_LENGTH];
+    uint8_t priority;
+  };
+
 private:
   RTCANDriver &rtcan;
   // FIXME to move in pub/sub?
   rtcan_msg_t header_buffer[10];
   MemoryPool<rtcan_msg_t> header_pool;
 
-  BaseSubscriberQueue subp_queue;
-
   enum { MGMT_BUFFER_LENGTH = 4 };
   MgmtMsg mgmt_msgbuf[MGMT_BUFFER_LENGTH];
   TimestampedMsgPtrQueue::Entry mgmt_msgqueue_buf[MGMT_BUFFER_LENGTH];
   RTCANSubscriber * mgmt_rsub;
   RTCANPublisher * mgmt_rpub;
 
+  // Slots used on the bus, either allocated here or learned from the peers
+  Assignment assignments[MAX_ASSIGNMENTS];
+  size_t num_assignments;
+
+  // Fixed priorities, taking the place of the publish timeouts
+  PriorityOverride priority_overrides[MAX_PRIORITY_OVERRIDES];
+  size_t num_priority_overrides;
+
 public:
-  bool send(Message * msgp, RTCANSubscriber * rsubp);
+  void pump_tx_unsafe();
+  void flush_tx_unsafe();
 
-  rtcan_id_t topic_id(const Topic &topic) const; // FIXME
+  rtcan_id_t topic_id(const Topic &topic);
+  uint8_t allocate_slot(const Topic &topic);
+  void learn_slot_unsafe(const MgmtMsg &msg);
+
+  bool set_priority(const char *namep, uint8_t priority);
 
   void initialize(const RTCANConfig &rtcan_config);
   void fill_raw_params(const Topic &topic, uint8_t raw_params[]);
 
 private:
   RemotePublisher *create_publisher(Topic &topic, const uint8_t raw_params[] = NULL) const;
+  void refresh_publisher(RemotePublisher &pub, const uint8_t raw_params[]);
   RemoteSubscriber *create_subscriber(
     Topic &topic,
     TimestampedMsgPtrQueue::Entry queue_buf[], // TODO: remove
@@ -54,6 +124,20 @@ public:
   RTCANTransport(RTCANDriver &rtcan);
   ~RTCANTransport();
 
+private:
+  bool is_slot_taken_unsafe(uint8_t slot) const;
+  Assignment *find_assignment_unsafe(const char *namep);
+  Assignment *find_owner_unsafe(uint8_t slot);
+  uint8_t find_priority_unsafe(const char *namep, const Time &publish_timeout) const;
+  uint8_t find_free_slot_unsafe(const char *namep, const Time &publish_timeout) const;
+  Assignment *assign_slot_unsafe(const char *namep, uint8_t slot, const Topic *topicp);
+  void move_slot_unsafe(Assignment &assignment, uint8_t slot);
+  void advertise_slot_unsafe(const Assignment &assignment);
+
+public:
+  static uint8_t compute_priority(const Time &publish_timeout);
+  static bool wins_slot(const char *namep, const char *otherp);
+
 private:
   static void send_cb(rtcan_msg_t &rtcan_msg);
   static void recv_cb(rtcan_msg_t &rtcan_msg);
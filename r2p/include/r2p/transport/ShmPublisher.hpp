@@ -0,0 +1,17 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/RemotePublisher.hpp>
+#include <r2p/StaticList.hpp>
+
+namespace r2p {
+
+
+class ShmPublisher : public RemotePublisher {
+public:
+  ShmPublisher(Transport &transport);
+  ~ShmPublisher();
+};
+
+
+} // namespace r2p
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/RemoteSubscriber.hpp>
+#include <r2p/TimestampedMsgPtrQueue.hpp>
+
+namespace r2p {
+
+class ShmTransport;
+
+
+class ShmSubscriber : public RemoteSubscriber {
+  friend class ShmTransport;
+
+public:
+  ShmSubscriber(ShmTransport &transport,
+                TimestampedMsgPtrQueue::Entry queue_buf[],
+                size_t queue_length);
+  ~ShmSubscriber();
+};
+
+
+} // namespace r2p
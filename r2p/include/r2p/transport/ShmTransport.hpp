@@ -0,0 +1,175 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/Transport.hpp>
+#include <r2p/TimestampedMsgPtrQueue.hpp>
+#include <r2p/MgmtMsg.hpp>
+
+#include <semaphore.h>
+#include <sys/types.h>
+
+#include "ShmPublisher.hpp"
+#include "ShmSubscriber.hpp"
+#include <r2p/Thread.hpp>
+
+namespace r2p {
+
+#if !defined(R2P_SHMTRANSPORT_RING_LENGTH) || defined(__DOXYGEN__)
+#define R2P_SHMTRANSPORT_RING_LENGTH    64
+#endif
+
+#if !defined(R2P_SHMTRANSPORT_MAX_PAYLOAD) || defined(__DOXYGEN__)
+#define R2P_SHMTRANSPORT_MAX_PAYLOAD    256
+#endif
+
+
+// Point-to-point link between two processes of the same host, through a
+// POSIX shared memory segment holding one single-producer single-consumer
+// ring of message slots per direction. The sender copies the payload into a
+// slot, the receiver copies it out into a message of its own pool.
+//
+// Side A creates a new segment at each start, as its semaphores cannot be
+// initialized under a waiting peer; it refuses to start while the processes
+// of a previous run are still attached to the old one.
+class ShmTransport : public Transport {
+public:
+  enum { RING_LENGTH = R2P_SHMTRANSPORT_RING_LENGTH };
+  enum { MAX_PAYLOAD = R2P_SHMTRANSPORT_MAX_PAYLOAD };
+
+  // The side which creates and initializes the segment is A
+  enum Side { SIDE_A = 0, SIDE_B = 1 };
+
+private:
+  enum { MAGIC = 0x52325053 }; // "R2PS"
+
+  struct Slot {
+    uint8_t   namelen;
+    char      name[NamingTraits<Topic>::MAX_LENGTH];
+    uint16_t  length;
+    uint8_t   data[MAX_PAYLOAD];
+  };
+
+  // Head written by the producer only, tail by the consumer only
+  struct Ring {
+    sem_t             sem;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t          num_drops;
+    Slot              slots[RING_LENGTH];
+  };
+
+  struct Segment {
+    volatile uint32_t magic;
+    volatile pid_t    pids[2];  // Attached processes, indexed by side
+    Ring              rings[2]; // Indexed by the receiving side
+  };
+
+private:
+  Thread *rx_threadp;
+  Thread *tx_threadp;
+
+  const char *shm_namep;
+  const uint8_t side;
+  int fd;
+  Segment *segmentp;
+
+  enum { MGMT_BUFFER_LENGTH = 4 };
+  TimestampedMsgPtrQueue::Entry mgmt_msgqueue_buf[MGMT_BUFFER_LENGTH];
+  MgmtMsg mgmt_msgbuf[MGMT_BUFFER_LENGTH];
+  ShmSubscriber mgmt_rsub;
+  ShmPublisher mgmt_rpub;
+
+public:
+  Side get_side() const;
+  uint32_t get_num_drops() const;
+
+  bool initialize(void *rx_stackp, size_t rx_stacklen,
+                  Thread::Priority rx_priority,
+                  void *tx_stackp, size_t tx_stacklen,
+                  Thread::Priority tx_priority);
+
+private:
+  RemotePublisher *create_publisher(Topic &topic,
+                                    const uint8_t raw_params[] = NULL) const;
+  RemoteSubscriber *create_subscriber(
+    Topic &topic,
+    TimestampedMsgPtrQueue::Entry queue_buf[],
+    size_t queue_length
+  ) const;
+
+  bool spin_tx();
+  bool spin_rx();
+
+private:
+  bool open_segment();
+  bool create_segment();
+  bool attach_segment();
+  Ring &get_tx_ring();
+  Ring &get_rx_ring();
+  bool push(const Topic &topic, const Message &msg);
+  bool dispatch(const Slot &slot);
+
+public:
+  ShmTransport(const char *namep, const char *shm_namep, Side side);
+  ~ShmTransport();
+
+private:
+  static bool is_alive(pid_t pid);
+  static Thread::Return rx_threadf(Thread::Argument arg);
+  static Thread::Return tx_threadf(Thread::Argument arg);
+};
+
+
+inline
+ShmTransport::Side ShmTransport::get_side() const {
+
+  return static_cast<Side>(side);
+}
+
+
+inline
+uint32_t ShmTransport::get_num_drops() const {
+
+  return (segmentp != NULL) ? segmentp->rings[1 - side].num_drops : 0;
+}
+
+
+inline
+ShmTransport::Ring &ShmTransport::get_tx_ring() {
+
+  return segmentp->rings[1 - side];
+}
+
+
+inline
+ShmTransport::Ring &ShmTransport::get_rx_ring() {
+
+  return segmentp->rings[side];
+}
+
+
+inline
+RemotePublisher *ShmTransport::create_publisher(Topic &topic,
+                                                const uint8_t raw_params[])
+const {
+
+  (void)topic;
+  (void)raw_params;
+  return new ShmPublisher(*const_cast<ShmTransport *>(this));
+}
+
+
+inline
+RemoteSubscriber *ShmTransport::create_subscriber(
+  Topic &topic,
+  TimestampedMsgPtrQueue::Entry queue_buf[],
+  size_t queue_length) const {
+
+  // A slot could not hold its messages
+  if (topic.get_payload_size() > MAX_PAYLOAD) return NULL;
+  return new ShmSubscriber(*const_cast<ShmTransport *>(this),
+                           queue_buf, queue_length);
+}
+
+
+} // namespace r2p
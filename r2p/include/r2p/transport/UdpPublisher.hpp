@@ -0,0 +1,17 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/RemotePublisher.hpp>
+#include <r2p/StaticList.hpp>
+
+namespace r2p {
+
+
+class UdpPublisher : public RemotePublisher {
+public:
+  UdpPublisher(Transport &transport);
+  ~UdpPublisher();
+};
+
+
+} // namespace r2p
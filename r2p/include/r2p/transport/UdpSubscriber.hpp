@@ -0,0 +1,23 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/RemoteSubscriber.hpp>
+#include <r2p/TimestampedMsgPtrQueue.hpp>
+
+namespace r2p {
+
+class UdpTransport;
+
+
+class UdpSubscriber : public RemoteSubscriber {
+  friend class UdpTransport;
+
+public:
+  UdpSubscriber(UdpTransport &transport,
+                TimestampedMsgPtrQueue::Entry queue_buf[],
+                size_t queue_length);
+  ~UdpSubscriber();
+};
+
+
+} // namespace r2p
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/Transport.hpp>
+#include <r2p/TimestampedMsgPtrQueue.hpp>
+#include <r2p/Mutex.hpp>
+#include <r2p/MgmtMsg.hpp>
+
+#include "UdpPublisher.hpp"
+#include "UdpSubscriber.hpp"
+#include <r2p/Thread.hpp>
+
+namespace r2p {
+
+#if !defined(R2P_UDPTRANSPORT_DATAGRAM_LENGTH) || defined(__DOXYGEN__)
+#define R2P_UDPTRANSPORT_DATAGRAM_LENGTH    1472
+#endif
+
+#if !defined(R2P_UDPTRANSPORT_MAX_ROUTES) || defined(__DOXYGEN__)
+#define R2P_UDPTRANSPORT_MAX_ROUTES         16
+#endif
+
+
+// Management messages go to a multicast group, so that modules find each
+// other without configuration; topic data goes by unicast to the modules
+// which asked for it. Each datagram carries a batch of messages of a topic:
+//   magic (4), sender ID (4), name length (1), name, payload size (2),
+//   then as many payloads as fit.
+class UdpTransport : public Transport {
+public:
+  enum { DATAGRAM_LENGTH = R2P_UDPTRANSPORT_DATAGRAM_LENGTH };
+  enum { MAX_ROUTES = R2P_UDPTRANSPORT_MAX_ROUTES };
+
+  // IPv4 address and port, both in network byte order
+  struct Endpoint {
+    uint32_t addr;
+    uint16_t port;
+  };
+
+private:
+  enum {
+    MAGIC0          = 'R',
+    MAGIC1          = '2',
+    MAGIC2          = 'P',
+    MAGIC3          = 'U',
+
+    HEADER_LENGTH   = 4 + sizeof(uint32_t),
+  };
+
+  // Where to send the data of a topic, learned from subscription requests
+  struct Route {
+    char topic[NamingTraits<Topic>::MAX_LENGTH];
+    Endpoint endpoint;
+  };
+
+private:
+  Thread *rx_threadp;
+  Thread *tx_threadp;
+
+  Endpoint group;
+  uint16_t data_port;
+  int mgmt_fd;
+  int data_fd;
+
+  // Drops the own multicast datagrams looped back by the stack
+  uint32_t sender_id;
+
+  Mutex routes_lock;
+  Route routes[MAX_ROUTES];
+  size_t num_routes;
+
+  // Datagram under construction; TX thread only
+  uint8_t txbuf[DATAGRAM_LENGTH];
+  // Last datagram received; RX thread only
+  uint8_t rxbuf[DATAGRAM_LENGTH];
+
+  enum { MGMT_BUFFER_LENGTH = 4 };
+  TimestampedMsgPtrQueue::Entry mgmt_msgqueue_buf[MGMT_BUFFER_LENGTH];
+  MgmtMsg mgmt_msgbuf[MGMT_BUFFER_LENGTH];
+  UdpSubscriber mgmt_rsub;
+  UdpPublisher mgmt_rpub;
+
+public:
+  size_t get_num_routes() const;
+
+  bool initialize(void *rx_stackp, size_t rx_stacklen,
+                  Thread::Priority rx_priority,
+                  void *tx_stackp, size_t tx_stacklen,
+                  Thread::Priority tx_priority);
+
+private:
+  RemotePublisher *create_publisher(Topic &topic,
+                                    const uint8_t raw_params[] = NULL) const;
+  RemoteSubscriber *create_subscriber(
+    Topic &topic,
+    TimestampedMsgPtrQueue::Entry queue_buf[],
+    size_t queue_length
+  ) const;
+
+  bool spin_tx();
+  bool spin_rx();
+
+private:
+  bool open_sockets();
+  size_t begin_datagram(const Topic &topic);
+  bool send_datagram(const Topic &topic, size_t length);
+  bool recv_datagram(int fd, Endpoint &source, size_t &length);
+  bool process_datagram(const Endpoint &source, size_t length);
+  bool dispatch(RemotePublisher &pub, const uint8_t *payloadp,
+                const Endpoint &source);
+  void add_route(const char *topicp, const Endpoint &endpoint);
+
+public:
+  UdpTransport(const char *namep, const char *group_addrp,
+               uint16_t group_port, uint16_t data_port);
+  ~UdpTransport();
+
+private:
+  static Thread::Return rx_threadf(Thread::Argument arg);
+  static Thread::Return tx_threadf(Thread::Argument arg);
+};
+
+
+inline
+size_t UdpTransport::get_num_routes() const {
+
+  return num_routes;
+}
+
+
+inline
+RemotePublisher *UdpTransport::create_publisher(Topic &topic,
+                                                const uint8_t raw_params[])
+const {
+
+  (void)topic;
+  (void)raw_params;
+  return new UdpPublisher(*const_cast<UdpTransport *>(this));
+}
+
+
+inline
+RemoteSubscriber *UdpTransport::create_subscriber(
+  Topic &topic,
+  TimestampedMsgPtrQueue::Entry queue_buf[],
+  size_t queue_length) const {
+
+  (void)topic;
+  return new UdpSubscriber(*const_cast<UdpTransport *>(this),
+                           queue_buf, queue_length);
+}
+
+
+} // namespace r2p
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <r2p/common.hpp>
+
+namespace r2p {
+
+
+class Atomic_ : private Uncopyable {
+private:
+  Atomic_();
+
+public:
+  static void barrier();
+  static bool compare_and_swap(volatile size_t &value,
+                               size_t expected, size_t desired);
+};
+
+
+inline
+void Atomic_::barrier() {
+
+  // Single core, only the compiler must not reorder memory accesses
+  __asm__ __volatile__ ("" ::: "memory");
+}
+
+
+inline
+bool Atomic_::compare_and_swap(volatile size_t &value,
+                               size_t expected, size_t desired) {
+
+  // LDREX/STREX loop on ARMv7-M, no need to mask interrupts
+  return __sync_bool_compare_and_swap(&value, expected, desired);
+}
+
+
+} // namespace r2p
@@ -29,12 +29,26 @@ public:
 
   ::Semaphore &get_impl();
 
+private:
+  static systime_t to_ticks(const Time &timeout);
+
 public:
   Semaphore_(Count value = 0);
   explicit Semaphore_(bool initialize, Count value = 0);
 };
 
 
+inline
+systime_t Semaphore_::to_ticks(const Time &timeout) {
+
+  // US2ST() overflows past a few seconds, and would wait on the sentinels
+  if      (timeout <= Time::IMMEDIATE)   return TIME_IMMEDIATE;
+  else if (timeout == Time::INFINITE)    return TIME_INFINITE;
+  else if (timeout.to_us_raw() > 100000) return MS2ST(timeout.to_ms_raw());
+  else                                   return US2ST(timeout.to_us_raw());
+}
+
+
 inline
 void Semaphore_::initialize(Count value) {
 
@@ -66,7 +80,7 @@ void Semaphore_::wait_unsafe() {
 inline
 bool Semaphore_::wait_unsafe(const Time &timeout) {
 
-  return chSemWaitTimeoutS(&impl, US2ST(timeout.to_us_raw())) == RDY_OK;
+  return chSemWaitTimeoutS(&impl, to_ticks(timeout)) == RDY_OK;
 }
 
 
@@ -94,7 +108,7 @@ void Semaphore_::wait() {
 inline
 bool Semaphore_::wait(const Time &timeout) {
 
-  return chSemWaitTimeout(&impl, US2ST(timeout.to_us_raw())) == RDY_OK;
+  return chSemWaitTimeout(&impl, to_ticks(timeout)) == RDY_OK;
 }
 
 
@@ -1,15 +1,42 @@
 
 #include <r2p/Time.hpp>
 #include <ch.h>
+#include <hal.h>
 
 namespace r2p {
 
 
+// System ticks extended to 64 bits, plus the elapsed part of the current tick
+// read from the SysTick down-counter. Masks interrupts with PRIMASK instead
+// of the kernel lock, so that it works from any context, even under SysLock.
 Time Time::now() {
 
-  register Type t = chTimeNow() / (CH_FREQUENCY / 1000L);
-  return ms((t == INFINITEN.raw) ? (t + 1) :
-            (t ==  INFINITE.raw) ? (t - 1) : t);
+  static systime_t last_ticks = 0;
+  static uint32_t num_wraps = 0;
+
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  register systime_t ticks = chTimeNow();
+  register uint32_t count = SysTick->VAL;
+  if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0) {
+    // The counter reloaded, but the tick interrupt has not run yet
+    count = SysTick->VAL;
+    ++ticks;
+  }
+  if (ticks < last_ticks) {
+    ++num_wraps;
+  }
+  last_ticks = ticks;
+  const uint32_t reload = SysTick->LOAD + 1;
+  const uint32_t wraps = num_wraps;
+  __set_PRIMASK(primask);
+
+  const uint64_t elapsed = (static_cast<uint64_t>(wraps) << 32) | ticks;
+  const uint32_t fraction = reload - 1 - count;
+  return us(static_cast<Type>(
+    elapsed * (1000000 / CH_FREQUENCY) +
+    static_cast<uint64_t>(fraction) * (1000000 / CH_FREQUENCY) / reload
+  ));
 }
 
 
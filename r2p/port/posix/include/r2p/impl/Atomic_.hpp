@@ -0,0 +1,34 @@
+#pragma once
+
+#include <r2p/common.hpp>
+
+namespace r2p {
+
+
+class Atomic_ : private Uncopyable {
+private:
+  Atomic_();
+
+public:
+  static void barrier();
+  static bool compare_and_swap(volatile size_t &value,
+                               size_t expected, size_t desired);
+};
+
+
+inline
+void Atomic_::barrier() {
+
+  __sync_synchronize();
+}
+
+
+inline
+bool Atomic_::compare_and_swap(volatile size_t &value,
+                               size_t expected, size_t desired) {
+
+  return __sync_bool_compare_and_swap(&value, expected, desired);
+}
+
+
+} // namespace r2p
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <r2p/common.hpp>
+
+namespace r2p {
+
+
+class MemoryPool_ : private Uncopyable {
+public:
+  typedef void *(*Allocator)(size_t size);
+
+private:
+  struct Header {
+    Header *nextp;
+  };
+
+  Header *headp;
+  size_t blocklen;
+  Allocator allocator;
+
+public:
+  size_t get_item_size() const;
+  Allocator get_allocator() const;
+
+  void *alloc_unsafe();
+  void free_unsafe(void *objp);
+
+  void *alloc();
+  void free(void *objp);
+  void extend(void *arrayp, size_t arraylen);
+
+public:
+  MemoryPool_(size_t blocklen);
+  MemoryPool_(void *arrayp, size_t length, size_t blocklen);
+  MemoryPool_(size_t blocklen, Allocator allocator);
+  MemoryPool_(void *arrayp, size_t length,
+              size_t blocklen, Allocator allocator);
+};
+
+
+inline
+size_t MemoryPool_::get_item_size() const {
+
+  return blocklen;
+}
+
+
+inline
+MemoryPool_::Allocator MemoryPool_::get_allocator() const {
+
+  return allocator;
+}
+
+
+inline
+void *MemoryPool_::alloc_unsafe() {
+
+  Header *blockp = headp;
+  if (blockp != NULL) {
+    headp = blockp->nextp;
+    return blockp;
+  }
+  return (allocator != NULL) ? allocator(blocklen) : NULL;
+}
+
+
+inline
+void MemoryPool_::free_unsafe(void *objp) {
+
+  if (objp != NULL) {
+    R2P_ASSERT(blocklen >= sizeof(Header));
+
+    Header *blockp = reinterpret_cast<Header *>(objp);
+    blockp->nextp = headp;
+    headp = blockp;
+  }
+}
+
+
+inline
+void *MemoryPool_::alloc() {
+
+  SysLock::acquire();
+  void *objp = alloc_unsafe();
+  SysLock::release();
+  return objp;
+}
+
+
+inline
+void MemoryPool_::free(void *objp) {
+
+  SysLock::acquire();
+  free_unsafe(objp);
+  SysLock::release();
+}
+
+
+inline
+void MemoryPool_::extend(void *arrayp, size_t length) {
+
+  // Free blocks hold the link, as with chPoolInit()
+  R2P_ASSERT(blocklen >= sizeof(Header));
+
+  uint8_t *blockp = reinterpret_cast<uint8_t *>(arrayp);
+  for (; length > 0; --length, blockp += blocklen) {
+    free(blockp);
+  }
+}
+
+
+inline
+MemoryPool_::MemoryPool_(size_t blocklen)
+:
+  headp(NULL),
+  blocklen(blocklen),
+  allocator(NULL)
+{}
+
+
+inline
+MemoryPool_::MemoryPool_(void *arrayp, size_t length, size_t blocklen)
+:
+  headp(NULL),
+  blocklen(blocklen),
+  allocator(NULL)
+{
+  extend(arrayp, length);
+}
+
+
+inline
+MemoryPool_::MemoryPool_(size_t blocklen, Allocator allocator)
+:
+  headp(NULL),
+  blocklen(blocklen),
+  allocator(allocator)
+{}
+
+
+inline
+MemoryPool_::MemoryPool_(void *arrayp, size_t length, size_t blocklen,
+                         Allocator allocator)
+:
+  headp(NULL),
+  blocklen(blocklen),
+  allocator(allocator)
+{
+  extend(arrayp, length);
+}
+
+
+} // namespace r2p
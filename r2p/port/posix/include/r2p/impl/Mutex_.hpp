@@ -0,0 +1,93 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <pthread.h>
+
+namespace r2p {
+
+
+class Mutex_ : private Uncopyable {
+private:
+  pthread_mutex_t impl;
+
+public:
+  void initialize();
+
+  void acquire_unsafe();
+  void release_unsafe();
+
+  void acquire();
+  void release();
+
+  pthread_mutex_t &get_impl();
+
+public:
+  Mutex_();
+  explicit Mutex_(bool initialize);
+};
+
+
+inline
+void Mutex_::initialize() {
+
+  pthread_mutex_init(&impl, NULL);
+}
+
+
+inline
+void Mutex_::acquire_unsafe() {
+
+  // Never block while holding SysLock, the owner may need it to go on
+  if (pthread_mutex_trylock(&impl) != 0) {
+    SysLock::release();
+    pthread_mutex_lock(&impl);
+    SysLock::acquire();
+  }
+}
+
+
+inline
+void Mutex_::release_unsafe() {
+
+  pthread_mutex_unlock(&impl);
+}
+
+
+inline
+void Mutex_::acquire() {
+
+  pthread_mutex_lock(&impl);
+}
+
+
+inline
+void Mutex_::release() {
+
+  pthread_mutex_unlock(&impl);
+}
+
+
+inline
+pthread_mutex_t &Mutex_::get_impl() {
+
+  return impl;
+}
+
+
+inline
+Mutex_::Mutex_() {
+
+  this->initialize();
+}
+
+
+inline
+Mutex_::Mutex_(bool initialize) {
+
+  if (initialize) {
+    this->initialize();
+  }
+}
+
+
+} // namespace r2p
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/Time.hpp>
+#include <pthread.h>
+
+namespace r2p {
+
+
+class Semaphore_ : private Uncopyable {
+public:
+  typedef int Count;
+
+private:
+  Count count;
+  unsigned resets; // Wakes up the waiters of a reset with a failure
+  pthread_cond_t cond;
+
+public:
+  void initialize(Count value = 0);
+
+  void reset_unsafe(Count value = 0);
+  void signal_unsafe();
+  void wait_unsafe();
+  bool wait_unsafe(const Time &timeout);
+
+  void reset(Count value = 0);
+  void signal();
+  void wait();
+  bool wait(const Time &timeout);
+
+  pthread_cond_t &get_impl();
+
+public:
+  Semaphore_(Count value = 0);
+  explicit Semaphore_(bool initialize, Count value = 0);
+};
+
+
+inline
+void Semaphore_::initialize(Count value) {
+
+  count = value;
+  resets = 0;
+  SysLock_::init_condition(cond);
+}
+
+
+inline
+void Semaphore_::reset_unsafe(Count value) {
+
+  count = value;
+  ++resets;
+  pthread_cond_broadcast(&cond);
+}
+
+
+inline
+void Semaphore_::signal_unsafe() {
+
+  ++count;
+  pthread_cond_signal(&cond);
+}
+
+
+inline
+void Semaphore_::wait_unsafe() {
+
+  wait_unsafe(Time::INFINITE);
+}
+
+
+inline
+bool Semaphore_::wait_unsafe(const Time &timeout) {
+
+  if (count <= 0) {
+    if (timeout == Time::IMMEDIATE) return false;
+
+    const unsigned resets = this->resets;
+    if (timeout == Time::INFINITE) {
+      while (count <= 0 && resets == this->resets) {
+        SysLock_::wait_unsafe(cond);
+      }
+    } else {
+      const struct timespec deadline =
+        SysLock_::compute_deadline(timeout.to_us_raw());
+      while (count <= 0 && resets == this->resets) {
+        if (!SysLock_::wait_unsafe(cond, deadline)) break;
+      }
+    }
+    if (count <= 0 || resets != this->resets) return false;
+  }
+  --count;
+  return true;
+}
+
+
+inline
+void Semaphore_::reset(Count value) {
+
+  SysLock::acquire();
+  reset_unsafe(value);
+  SysLock::release();
+}
+
+
+inline
+void Semaphore_::signal() {
+
+  SysLock::acquire();
+  signal_unsafe();
+  SysLock::release();
+}
+
+
+inline
+void Semaphore_::wait() {
+
+  SysLock::acquire();
+  wait_unsafe();
+  SysLock::release();
+}
+
+
+inline
+bool Semaphore_::wait(const Time &timeout) {
+
+  SysLock::acquire();
+  bool success = wait_unsafe(timeout);
+  SysLock::release();
+  return success;
+}
+
+
+inline
+pthread_cond_t &Semaphore_::get_impl() {
+
+  return cond;
+}
+
+
+inline
+Semaphore_::Semaphore_(Count value) {
+
+  initialize(value);
+}
+
+
+inline
+Semaphore_::Semaphore_(bool initialize, Count value) {
+
+  if (initialize) {
+    this->initialize(value);
+  }
+}
+
+
+} // namespace r2p
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <r2p/Time.hpp>
+#include <r2p/Thread.hpp>
+
+namespace r2p {
+
+
+class SpinEvent_ {
+public:
+  typedef Thread_::EventMask Mask;
+
+private:
+  Thread *threadp;
+
+public:
+  Thread *get_thread() const;
+  void set_thread(Thread *threadp);
+
+  void signal_unsafe(unsigned event_index);
+
+  void signal(unsigned event_index);
+  Mask wait(const Time &timeout);
+
+public:
+  SpinEvent_(Thread *threadp = &Thread::self());
+};
+
+
+inline
+Thread *SpinEvent_::get_thread() const {
+
+  return threadp;
+}
+
+
+inline
+void SpinEvent_::set_thread(Thread *threadp) {
+
+  this->threadp = threadp;
+}
+
+
+inline
+void SpinEvent_::signal_unsafe(unsigned event_index) {
+
+  if (threadp != NULL) {
+    R2P_ASSERT(event_index < 8 * sizeof(Mask));
+    reinterpret_cast<Thread_ *>(threadp)->signal_events_unsafe(
+      static_cast<Mask>(1) << event_index
+    );
+  }
+}
+
+
+inline
+void SpinEvent_::signal(unsigned event_index) {
+
+  SysLock::acquire();
+  signal_unsafe(event_index);
+  SysLock::release();
+}
+
+
+inline
+SpinEvent_::Mask SpinEvent_::wait(const Time &timeout) {
+
+  SysLock::acquire();
+  Mask mask = Thread_::self().wait_events_unsafe(timeout);
+  SysLock::release();
+  return mask;
+}
+
+
+inline
+SpinEvent_::SpinEvent_(Thread *threadp)
+:
+  threadp(threadp)
+{}
+
+
+} // namespace r2p
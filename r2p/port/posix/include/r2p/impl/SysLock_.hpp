@@ -1,5 +1,10 @@
 #pragma once
 
+#include <r2p/Uncopyable.hpp>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
 namespace r2p {
 
 
@@ -11,24 +16,37 @@ public:
   static void acquire();
   static void release();
 
+  // Condition variables waited on while holding the lock, as the S-state
+  // functions of ChibiOS do; deadlines are absolute, on CLOCK_MONOTONIC
+  static void init_condition(pthread_cond_t &cond);
+  static struct timespec compute_deadline(int64_t timeout_us);
+  static void wait_unsafe(pthread_cond_t &cond);
+  static bool wait_unsafe(pthread_cond_t &cond,
+                          const struct timespec &deadline);
+
 private:
-  static volatile unsigned exclusion;
+  static pthread_mutex_t mutex;
 };
 
 
 inline
 void SysLock_::acquire() {
 
-  while (__sync_lock_test_and_set(&exclusion, 1)) {
-    while (exclusion) {}
-  }
+  pthread_mutex_lock(&mutex);
 }
 
 
 inline
 void SysLock_::release() {
 
-  __sync_lock_release(&exclusion);
+  pthread_mutex_unlock(&mutex);
+}
+
+
+inline
+void SysLock_::wait_unsafe(pthread_cond_t &cond) {
+
+  pthread_cond_wait(&cond, &mutex);
 }
 
 
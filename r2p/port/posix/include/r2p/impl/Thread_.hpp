@@ -0,0 +1,142 @@
+#pragma once
+
+#include <r2p/common.hpp>
+#include <pthread.h>
+
+namespace r2p {
+
+class MemoryPool_;
+class Time;
+
+
+// The descriptor lives at the start of the working area, like the ChibiOS
+// one, but the thread runs on the stack that pthreads gives it. Priorities
+// are only recorded, the host scheduler decides.
+// No Uncopyable base, as in the ChibiOS port: Thread reinterprets a Thread_
+// as itself, so its impl member must sit at offset 0.
+class Thread_ {
+public:
+  enum PriorityEnum {
+    READY       = 0,
+    IDLE        = 1,
+    LOWEST      = 2,
+    NORMAL      = 64,
+    HIGHEST     = 126,
+    INTERRUPT   = 127
+  };
+
+  enum { OK = 0 };
+
+  typedef int Priority;
+  typedef long Return;
+  typedef void *Argument;
+  typedef Return (*Function)(Argument);
+
+  typedef uint32_t EventMask;
+
+private:
+  enum { ALIGNMENT = 16 };
+
+  pthread_t impl;
+  Function threadf;
+  Argument argp;
+  const char *namep;
+  Priority priority;
+  MemoryPool_ *mempoolp;
+  bool on_heap;
+
+  // Guarded by SysLock
+  EventMask events;
+  pthread_cond_t events_cond;
+
+public:
+  const char *get_name() const;
+
+  pthread_t &get_impl();
+
+  void signal_events_unsafe(EventMask mask);
+  EventMask wait_events_unsafe(const Time &timeout);
+
+private:
+  Thread_(Function threadf, Argument argp, Priority priority,
+          const char *namep);
+
+  static Thread_ *start(Thread_ *threadp);
+  static void *trampoline(void *argp);
+
+public:
+  static size_t compute_stack_size(size_t userlen);
+  static Thread_ *create_static(void *stackp, size_t stacklen,
+                                Priority priority,
+                                Function threadf, void *argp,
+                                const char *namep = NULL);
+  static Thread_ *create_heap(void *heapp, size_t stacklen, Priority priority,
+                              Function threadf, void *argp,
+                              const char *namep = NULL);
+  static Thread_ *create_pool(MemoryPool_ &mempool, Priority priority,
+                              Function threadf, void *argp,
+                              const char *namep = NULL);
+  static Thread_ &self();
+  static Priority get_priority();
+  static void set_priority(Priority priority);
+  static void yield();
+  static void sleep(const Time &delay);
+  static bool join(Thread_ &thread);
+
+private:
+  static __thread Thread_ *selfp;
+};
+
+
+} // namespace r2p
+
+#include <r2p/impl/MemoryPool_.hpp>
+#include <r2p/Time.hpp>
+
+namespace r2p {
+
+
+inline
+const char *Thread_::get_name() const {
+
+  return namep;
+}
+
+
+inline
+pthread_t &Thread_::get_impl() {
+
+  return impl;
+}
+
+
+inline
+void Thread_::signal_events_unsafe(EventMask mask) {
+
+  events |= mask;
+  pthread_cond_signal(&events_cond);
+}
+
+
+inline
+size_t Thread_::compute_stack_size(size_t userlen) {
+
+  return sizeof(Thread_) + ALIGNMENT + userlen;
+}
+
+
+inline
+Thread_::Priority Thread_::get_priority() {
+
+  return self().priority;
+}
+
+
+inline
+void Thread_::set_priority(Priority priority) {
+
+  self().priority = priority;
+}
+
+
+} // namespace r2p
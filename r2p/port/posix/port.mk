@@ -0,0 +1,14 @@
+ifeq ($(R2PSRC),)
+  $(error r2p.mk must be inclused before port.mk)
+endif
+
+R2PSRC += $(R2P)/port/posix/src/impl/Middleware_.cpp \
+          $(R2P)/port/posix/src/impl/SysLock_.cpp \
+          $(R2P)/port/posix/src/impl/Thread_.cpp \
+          $(R2P)/port/posix/src/impl/Time_.cpp
+
+ifeq ($(R2P_USE_BOOTLOADER),yes)
+  $(error the posix port has no bootloader, set R2P_USE_BOOTLOADER = no)
+endif
+
+R2PINC += $(R2P)/port/posix/include
@@ -0,0 +1,17 @@
+
+#include <r2p/Middleware.hpp>
+
+#include <cstdlib>
+
+namespace r2p {
+
+
+void Middleware::reboot() {
+
+  // A host process has nothing to reset, its supervisor restarts it
+  Thread::sleep(Time::ms(10));
+  exit(EXIT_SUCCESS);
+}
+
+
+} // namespace r2p
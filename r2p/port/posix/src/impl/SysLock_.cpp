@@ -1,10 +1,44 @@
 
 #include <r2p/impl/SysLock_.hpp>
+#include <errno.h>
 
 namespace r2p {
 
 
-volatile unsigned SysLock_::exclusion = 0;
+pthread_mutex_t SysLock_::mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+void SysLock_::init_condition(pthread_cond_t &cond) {
+
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+
+struct timespec SysLock_::compute_deadline(int64_t timeout_us) {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  const int64_t ns = static_cast<int64_t>(ts.tv_nsec) +
+                     (timeout_us % 1000000) * 1000;
+  ts.tv_sec += static_cast<time_t>(timeout_us / 1000000 + ns / 1000000000);
+  ts.tv_nsec = static_cast<long>(ns % 1000000000);
+  return ts;
+}
+
+
+bool SysLock_::wait_unsafe(pthread_cond_t &cond,
+                           const struct timespec &deadline) {
+
+  int err;
+  do {
+    err = pthread_cond_timedwait(&cond, &mutex, &deadline);
+  } while (err == EINTR);
+  return err != ETIMEDOUT;
+}
 
 
 } // namespace r2p
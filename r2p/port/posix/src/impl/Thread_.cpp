@@ -0,0 +1,172 @@
+
+#include <r2p/impl/Thread_.hpp>
+
+#include <cstdlib>
+#include <new>
+#include <sched.h>
+
+namespace r2p {
+
+
+__thread Thread_ *Thread_::selfp = NULL;
+
+
+Thread_::EventMask Thread_::wait_events_unsafe(const Time &timeout) {
+
+  if (events == 0 && timeout != Time::IMMEDIATE) {
+    if (timeout == Time::INFINITE) {
+      while (events == 0) {
+        SysLock_::wait_unsafe(events_cond);
+      }
+    } else {
+      const struct timespec deadline =
+        SysLock_::compute_deadline(timeout.to_us_raw());
+      while (events == 0 && SysLock_::wait_unsafe(events_cond, deadline)) {}
+    }
+  }
+
+  EventMask mask = events;
+  events = 0;
+  return mask;
+}
+
+
+Thread_::Thread_(Function threadf, Argument argp, Priority priority,
+                 const char *namep)
+:
+  threadf(threadf),
+  argp(argp),
+  namep(namep),
+  priority(priority),
+  mempoolp(NULL),
+  on_heap(false),
+  events(0)
+{
+  SysLock_::init_condition(events_cond);
+}
+
+
+Thread_ *Thread_::start(Thread_ *threadp) {
+
+  if (pthread_create(&threadp->impl, NULL, trampoline, threadp) != 0) {
+    pthread_cond_destroy(&threadp->events_cond);
+    return NULL;
+  }
+  return threadp;
+}
+
+
+void *Thread_::trampoline(void *argp) {
+
+  Thread_ *threadp = reinterpret_cast<Thread_ *>(argp);
+  selfp = threadp;
+  return reinterpret_cast<void *>(threadp->threadf(threadp->argp));
+}
+
+
+Thread_ *Thread_::create_static(void *stackp, size_t stacklen,
+                                Priority priority,
+                                Function threadf, void *argp,
+                                const char *namep) {
+
+  R2P_ASSERT(stackp != NULL);
+
+  const uintptr_t mask = ALIGNMENT - 1;
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(stackp);
+  const uintptr_t aligned = (addr + mask) & ~mask;
+  if (stacklen < (aligned - addr) + sizeof(Thread_)) return NULL;
+
+  Thread_ *threadp = new (reinterpret_cast<void *>(aligned))
+                     Thread_(threadf, argp, priority, namep);
+  return start(threadp);
+}
+
+
+Thread_ *Thread_::create_heap(void *heapp, size_t stacklen, Priority priority,
+                              Function threadf, void *argp,
+                              const char *namep) {
+
+  (void)heapp;
+  (void)stacklen;
+  void *objp = malloc(sizeof(Thread_));
+  if (objp == NULL) return NULL;
+
+  Thread_ *threadp = new (objp) Thread_(threadf, argp, priority, namep);
+  threadp->on_heap = true;
+  if (start(threadp) == NULL) {
+    free(objp);
+    return NULL;
+  }
+  return threadp;
+}
+
+
+Thread_ *Thread_::create_pool(MemoryPool_ &mempool, Priority priority,
+                              Function threadf, void *argp,
+                              const char *namep) {
+
+  R2P_ASSERT(mempool.get_item_size() >= sizeof(Thread_));
+
+  void *objp = mempool.alloc();
+  if (objp == NULL) return NULL;
+
+  Thread_ *threadp = new (objp) Thread_(threadf, argp, priority, namep);
+  threadp->mempoolp = &mempool;
+  if (start(threadp) == NULL) {
+    mempool.free(objp);
+    return NULL;
+  }
+  return threadp;
+}
+
+
+Thread_ &Thread_::self() {
+
+  // Threads not created through r2p, like the main one, get a descriptor
+  // the first time they ask for it
+  if (selfp == NULL) {
+    void *objp = malloc(sizeof(Thread_));
+    R2P_ASSERT(objp != NULL);
+    selfp = new (objp) Thread_(NULL, NULL, NORMAL, "main");
+    selfp->impl = pthread_self();
+    selfp->on_heap = true;
+  }
+  return *selfp;
+}
+
+
+void Thread_::yield() {
+
+  sched_yield();
+}
+
+
+void Thread_::sleep(const Time &delay) {
+
+  if (delay.raw > 0) {
+    struct timespec ts;
+    ts.tv_sec = static_cast<time_t>(delay.raw / 1000000);
+    ts.tv_nsec = static_cast<long>(delay.raw % 1000000) * 1000;
+    while (nanosleep(&ts, &ts) != 0) {}
+  } else {
+    sched_yield();
+  }
+}
+
+
+bool Thread_::join(Thread_ &thread) {
+
+  if (pthread_join(thread.impl, NULL) != 0) return false;
+
+  // Like chThdWait(), release the descriptor of dynamic threads
+  pthread_cond_destroy(&thread.events_cond);
+  if (thread.mempoolp != NULL) {
+    thread.mempoolp->free(&thread);
+  } else if (thread.on_heap) {
+    free(&thread);
+  }
+  return true;
+}
+
+
+} // namespace r2p
@@ -0,0 +1,16 @@
+
+#include <r2p/Time.hpp>
+#include <time.h>
+
+namespace r2p {
+
+
+Time Time::now() {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return us(static_cast<Type>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000);
+}
+
+
+} // namespace r2p
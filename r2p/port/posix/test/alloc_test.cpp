@@ -0,0 +1,203 @@
+// Blocking Topic::alloc(timeout) on an exhausted pool: it gives up once the
+// timeout has elapsed, returns at once with Time::IMMEDIATE, and a free()
+// wakes one waiter per freed message. Built with R2P_USE_SHARED_MSG_POOL=1
+// (alloc_test_shared), a topic waiting on the shared slab is also woken by
+// another topic of the same size freeing a block.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Thread.hpp>
+#include <r2p/Topic.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+struct ValueMsg : public r2p::Message {
+  uint64_t value;
+} R2P_PACKED;
+
+// Another size, so that its slab class holds only its own blocks
+struct SlabMsg : public r2p::Message {
+  uint64_t values[2];
+} R2P_PACKED;
+
+enum { POOL_LENGTH = 2 };
+enum { NUM_WAITERS = 2 };
+enum { STACKLEN = 1024 };
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+// Only linked in, the topics are used on their own
+r2p::Middleware r2p::Middleware::instance("TEST", "BOOT_TEST"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t waiter_stacks[NUM_WAITERS][STACKLEN];
+
+struct Waiter {
+  r2p::Topic *topicp;
+  r2p::Time timeout;
+  r2p::Message *msgp;
+  r2p::Time elapsed;
+  volatile bool done;
+};
+
+
+static r2p::Thread::Return waiter_threadf(r2p::Thread::Argument arg) {
+
+  Waiter &waiter = *reinterpret_cast<Waiter *>(arg);
+  const r2p::Time start = r2p::Time::now();
+  waiter.msgp = waiter.topicp->alloc(waiter.timeout);
+  waiter.elapsed = r2p::Time::now() - start;
+  waiter.done = true;
+  return r2p::Thread::OK;
+}
+
+
+static r2p::Thread *start_waiter(unsigned index, Waiter &waiter,
+                                 r2p::Topic &topic, const r2p::Time &timeout) {
+
+  waiter.topicp = &topic;
+  waiter.timeout = timeout;
+  waiter.msgp = NULL;
+  waiter.done = false;
+  return r2p::Thread::create_static(waiter_stacks[index], STACKLEN,
+                                    r2p::Thread::NORMAL, waiter_threadf,
+                                    &waiter);
+}
+
+
+static bool check(bool condition, const char *whatp) {
+
+  if (!condition) {
+    printf("FAILED: %s\n", whatp);
+  }
+  return condition;
+}
+
+
+static bool test_timeout(r2p::Topic &topic) {
+
+  const r2p::Time timeout = r2p::Time::ms(50);
+  const r2p::Time start = r2p::Time::now();
+  r2p::Message *msgp = topic.alloc(timeout);
+  const r2p::Time elapsed = r2p::Time::now() - start;
+  bool ok = check(msgp == NULL, "no message once the timeout elapsed");
+  ok = check(elapsed >= timeout && elapsed < r2p::Time::s(1),
+             "waited for the timeout") && ok;
+  printf("timeout after %u us\n", static_cast<unsigned>(elapsed.to_us_raw()));
+
+  ok = check(topic.alloc(r2p::Time::IMMEDIATE) == NULL,
+             "no wait with an immediate timeout") && ok;
+  return ok;
+}
+
+
+// Two waiters on an empty pool, freed one message at a time
+static bool test_wakeup(r2p::Topic &topic, r2p::Message *msgps[]) {
+
+  static Waiter waiters[NUM_WAITERS];
+  r2p::Thread *threadps[NUM_WAITERS];
+  for (unsigned i = 0; i < NUM_WAITERS; ++i) {
+    threadps[i] = start_waiter(i, waiters[i], topic, r2p::Time::s(5));
+    if (threadps[i] == NULL) return check(false, "waiter thread");
+  }
+  r2p::Thread::sleep(r2p::Time::ms(50));
+  bool ok = check(!waiters[0].done && !waiters[1].done,
+                  "waiters blocked on the empty pool");
+
+  topic.free(*msgps[0]);
+  r2p::Thread::sleep(r2p::Time::ms(50));
+  ok = check(waiters[0].done != waiters[1].done,
+             "one waiter woken per free") && ok;
+
+  topic.free(*msgps[1]);
+  for (unsigned i = 0; i < NUM_WAITERS; ++i) {
+    r2p::Thread::join(*threadps[i]);
+  }
+  for (unsigned i = 0; i < NUM_WAITERS; ++i) {
+    ok = check(waiters[i].msgp != NULL, "woken with a message") && ok;
+    ok = check(waiters[i].elapsed < r2p::Time::s(1),
+               "woken well before the timeout") && ok;
+    printf("waiter %u woken after %u us\n", i,
+           static_cast<unsigned>(waiters[i].elapsed.to_us_raw()));
+  }
+  ok = check(waiters[0].msgp != waiters[1].msgp, "distinct messages") && ok;
+  for (unsigned i = 0; i < NUM_WAITERS; ++i) {
+    if (waiters[i].msgp != NULL) {
+      msgps[i] = waiters[i].msgp;
+    }
+  }
+  return ok;
+}
+
+
+#if R2P_USE_SHARED_MSG_POOL
+// The first topic has quota left but the slab is empty, the second topic
+// holds all the blocks of their class and frees one
+static bool test_shared() {
+
+  static SlabMsg waiting_buf[1], holding_buf[1];
+  static r2p::Topic waiting("waiting", sizeof(SlabMsg));
+  static r2p::Topic holding("holding", sizeof(SlabMsg));
+  waiting.extend_pool(waiting_buf, 1);
+  holding.extend_pool(holding_buf, 1);
+  holding.set_pool_quota(2);
+
+  r2p::Message *heldps[2];
+  for (unsigned i = 0; i < 2; ++i) {
+    if ((heldps[i] = holding.alloc()) == NULL) {
+      return check(false, "alloc of the whole slab class");
+    }
+  }
+
+  static Waiter waiter;
+  r2p::Thread *threadp = start_waiter(0, waiter, waiting, r2p::Time::s(5));
+  if (threadp == NULL) return check(false, "waiter thread");
+  r2p::Thread::sleep(r2p::Time::ms(50));
+  bool ok = check(!waiter.done, "waiter blocked on the empty slab");
+
+  holding.free(*heldps[0]);
+  r2p::Thread::join(*threadp);
+  ok = check(waiter.msgp == heldps[0], "woken by the other topic") && ok;
+  ok = check(waiter.elapsed < r2p::Time::s(1),
+             "woken well before the timeout") && ok;
+  printf("shared slab waiter woken after %u us\n",
+         static_cast<unsigned>(waiter.elapsed.to_us_raw()));
+  return ok;
+}
+#endif
+
+
+int main() {
+
+  static ValueMsg pool_buf[POOL_LENGTH];
+  static r2p::Topic topic("alloc", sizeof(ValueMsg));
+  topic.extend_pool(pool_buf, POOL_LENGTH);
+
+  r2p::Message *msgps[POOL_LENGTH];
+  bool ok = true;
+  for (unsigned i = 0; i < POOL_LENGTH; ++i) {
+    msgps[i] = topic.alloc();
+    ok = check(msgps[i] != NULL, "alloc from the pool") && ok;
+  }
+  if (ok) {
+    ok = test_timeout(topic);
+    ok = test_wakeup(topic, msgps) && ok;
+  }
+#if R2P_USE_SHARED_MSG_POOL
+  ok = test_shared() && ok;
+#endif
+
+  if (ok) {
+    printf("OK\n");
+  }
+  fflush(stdout);
+  _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
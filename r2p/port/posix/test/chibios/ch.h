@@ -0,0 +1,17 @@
+#pragma once
+
+// The few ChibiOS types DebugTransport uses, for the host tests only: times
+// are milliseconds, and a channel is a file descriptor.
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t systime_t;
+typedef int32_t msg_t;
+
+#define TIME_IMMEDIATE  ((systime_t)0)
+#define TIME_INFINITE   ((systime_t)-1)
+
+#define Q_OK            ((msg_t)0)
+#define Q_TIMEOUT       ((msg_t)-1)
+#define Q_RESET         ((msg_t)-2)
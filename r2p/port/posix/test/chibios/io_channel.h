@@ -0,0 +1,59 @@
+#pragma once
+
+// Blocking channel calls of ChibiOS over a file descriptor, for the host
+// tests only. Reads and writes stop at the timeout, or on an error.
+
+#include "ch.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+struct BaseChannel {
+  int fd;
+};
+
+
+static inline bool chn_wait(const BaseChannel *chp, short events,
+                            systime_t timeout) {
+
+  struct pollfd pfd;
+  pfd.fd = chp->fd;
+  pfd.events = events;
+  pfd.revents = 0;
+  const int ms = (timeout == TIME_INFINITE) ? -1 : static_cast<int>(timeout);
+  return poll(&pfd, 1, ms) == 1 && (pfd.revents & events) != 0;
+}
+
+
+static inline size_t chnReadTimeout(BaseChannel *chp, uint8_t *bufp,
+                                    size_t n, systime_t timeout) {
+
+  size_t length = 0;
+  while (length < n && chn_wait(chp, POLLIN, timeout)) {
+    const ssize_t got = read(chp->fd, bufp + length, n - length);
+    if (got <= 0) break;
+    length += static_cast<size_t>(got);
+  }
+  return length;
+}
+
+
+static inline size_t chnWriteTimeout(BaseChannel *chp, const uint8_t *bufp,
+                                     size_t n, systime_t timeout) {
+
+  size_t length = 0;
+  while (length < n && chn_wait(chp, POLLOUT, timeout)) {
+    const ssize_t put = write(chp->fd, bufp + length, n - length);
+    if (put <= 0) break;
+    length += static_cast<size_t>(put);
+  }
+  return length;
+}
+
+
+static inline msg_t chnGetTimeout(BaseChannel *chp, systime_t timeout) {
+
+  uint8_t byte;
+  if (chnReadTimeout(chp, &byte, 1, timeout) != 1) return Q_TIMEOUT;
+  return byte;
+}
@@ -0,0 +1,321 @@
+// RAM footprint of the led, pwm2 and pid2 firmware nodes, run each on its
+// own thread as in main.cpp, then all on one CooperativeExecutor spun by the
+// main thread. Both runs deliver the same messages; the stacks are sized as
+// the 1024-byte working areas of the firmware, and the deepest stack use of
+// the callbacks is measured on this host.
+// LedMsg and PWM2Msg are padded to a host pointer, the least a posix pool
+// block can hold.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/Executor.hpp>
+#include <r2p/Publisher.hpp>
+#include <r2p/Subscriber.hpp>
+#include <r2p/msg/motor.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct LedMsg : public r2p::Message {
+  uint32_t led;
+  uint8_t value;
+  uint8_t padding[3];
+} R2P_PACKED;
+
+struct PWM2Msg : public r2p::Message {
+  int16_t pwm1;
+  int16_t pwm2;
+  uint8_t padding[4];
+} R2P_PACKED;
+
+enum { NUM_NODES = 3 };
+enum { QUEUE_LENGTH = 5 };  // As in the firmware nodes
+enum { NUM_MSGS = 1000 };   // Per topic
+enum { STACKLEN = 1024 };   // WORKING_AREA of each node in main.cpp
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("TEST", "BOOT_TEST"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t mgmt_stack[STACKLEN];
+static uint8_t node_stacks[NUM_NODES][STACKLEN];
+
+static __thread const char *stack_basep;
+static volatile size_t max_stack_depth[NUM_NODES];
+static volatile unsigned num_received[4];
+static volatile unsigned num_ready = 0;
+
+
+static void note_stack(unsigned node) {
+
+  const char here = 0;
+  const size_t depth = static_cast<size_t>(stack_basep - &here);
+  if (depth > max_stack_depth[node]) {
+    max_stack_depth[node] = depth;
+  }
+}
+
+
+static bool led_cb(const LedMsg &msg) {
+
+  (void)msg;
+  note_stack(0);
+  ++num_received[0];
+  return true;
+}
+
+
+static bool pwm2_cb(const PWM2Msg &msg) {
+
+  (void)msg;
+  note_stack(1);
+  ++num_received[1];
+  return true;
+}
+
+
+static bool speed_cb(const r2p::Speed2Msg &msg) {
+
+  (void)msg;
+  note_stack(2);
+  ++num_received[2];
+  return true;
+}
+
+
+static bool encoder_cb(const r2p::tEncoderMsg &msg) {
+
+  (void)msg;
+  note_stack(2);
+  ++num_received[3];
+  return true;
+}
+
+
+// The nodes and their subscriptions, as set up by the firmware threads
+struct Nodes {
+  r2p::Node *nodeps[NUM_NODES];
+  r2p::Subscriber<LedMsg, QUEUE_LENGTH> led_sub;
+  r2p::Subscriber<PWM2Msg, QUEUE_LENGTH> pwm2_sub;
+  r2p::Subscriber<r2p::Speed2Msg, QUEUE_LENGTH> speed_sub;
+  r2p::Subscriber<r2p::tEncoderMsg, QUEUE_LENGTH> encoder_sub;
+
+  void setup(unsigned node) {
+    switch (node) {
+    case 0:
+      nodeps[0] = new r2p::Node("ledsub");
+      nodeps[0]->subscribe(led_sub, "led2");
+      break;
+    case 1:
+      nodeps[1] = new r2p::Node("pwm2sub");
+      nodeps[1]->subscribe(pwm2_sub, "pwm2");
+      break;
+    case 2:
+      nodeps[2] = new r2p::Node("pid2");
+      nodeps[2]->subscribe(speed_sub, "speed2");
+      nodeps[2]->subscribe(encoder_sub, "encoder");
+      break;
+    }
+  }
+
+  Nodes()
+  :
+    led_sub(led_cb),
+    pwm2_sub(pwm2_cb),
+    speed_sub(speed_cb),
+    encoder_sub(encoder_cb)
+  {}
+};
+
+static Nodes nodes;
+static volatile bool done = false;
+
+
+struct Publishers {
+  r2p::Node node;
+  r2p::Publisher<LedMsg> led_pub;
+  r2p::Publisher<PWM2Msg> pwm2_pub;
+  r2p::Publisher<r2p::Speed2Msg> speed_pub;
+  r2p::Publisher<r2p::tEncoderMsg> encoder_pub;
+
+  Publishers() : node("pub") {
+    node.advertise(led_pub, "led2");
+    node.advertise(pwm2_pub, "pwm2");
+    node.advertise(speed_pub, "speed2");
+    node.advertise(encoder_pub, "encoder");
+  }
+};
+
+
+typedef r2p::CooperativeExecutor<NUM_NODES> Executor;
+
+
+template<typename MT>
+static bool publish(r2p::Publisher<MT> &pub, Executor *executorp) {
+
+  MT *msgp;
+  for (unsigned tries = 0; !pub.alloc(msgp); ++tries) {
+    if (tries > 100000) return false;
+    if (executorp != NULL) {
+      executorp->spin(r2p::Time::IMMEDIATE);
+    } else {
+      r2p::Thread::yield();
+    }
+  }
+  pub.publish(*msgp);
+  return true;
+}
+
+
+static bool publish_all(Publishers &pubs, Executor *executorp) {
+
+  for (unsigned i = 0; i < NUM_MSGS; ++i) {
+    if (!publish(pubs.led_pub, executorp) ||
+        !publish(pubs.pwm2_pub, executorp) ||
+        !publish(pubs.speed_pub, executorp) ||
+        !publish(pubs.encoder_pub, executorp)) {
+      return false;
+    }
+    if (executorp != NULL) {
+      executorp->spin(r2p::Time::IMMEDIATE);
+    }
+  }
+  const r2p::Time deadline = r2p::Time::now() + r2p::Time::s(5);
+  for (;;) {
+    bool all = true;
+    for (unsigned k = 0; k < 4; ++k) {
+      all = all && num_received[k] == NUM_MSGS;
+    }
+    if (all) return true;
+    if (r2p::Time::now() >= deadline) return false;
+    if (executorp != NULL) {
+      executorp->spin(r2p::Time::ms(10));
+    } else {
+      r2p::Thread::sleep(r2p::Time::ms(1));
+    }
+  }
+}
+
+
+static r2p::Thread::Return node_threadf(r2p::Thread::Argument arg) {
+
+  const unsigned node = static_cast<unsigned>(
+    reinterpret_cast<uintptr_t>(arg)
+  );
+  const char base = 0;
+  stack_basep = &base;
+  nodes.setup(node);
+  __sync_fetch_and_add(&num_ready, 1);
+  while (!done) {
+    nodes.nodeps[node]->spin(r2p::Time::ms(100));
+  }
+  return r2p::Thread::OK;
+}
+
+
+static size_t deepest() {
+
+  size_t depth = 0;
+  for (unsigned i = 0; i < NUM_NODES; ++i) {
+    if (max_stack_depth[i] > depth) depth = max_stack_depth[i];
+  }
+  return depth;
+}
+
+
+static void print(const char *modep, size_t num_threads, size_t objects) {
+
+  const size_t stacks = num_threads * STACKLEN;
+  printf("%-12s %7u %7u %12u %7u %8u\n", modep,
+         static_cast<unsigned>(num_threads), static_cast<unsigned>(stacks),
+         static_cast<unsigned>(objects),
+         static_cast<unsigned>(stacks + objects),
+         static_cast<unsigned>(deepest()));
+}
+
+
+static int run_threads() {
+
+  for (uintptr_t i = 0; i < NUM_NODES; ++i) {
+    if (r2p::Thread::create_static(node_stacks[i], STACKLEN,
+                                   r2p::Thread::NORMAL, node_threadf,
+                                   reinterpret_cast<void *>(i)) == NULL) {
+      return 2;
+    }
+  }
+  while (num_ready < NUM_NODES) {
+    r2p::Thread::sleep(r2p::Time::ms(1));
+  }
+
+  static Publishers pubs;
+  if (!publish_all(pubs, NULL)) return 1;
+  print("per-node", NUM_NODES, NUM_NODES * sizeof(r2p::Node));
+  done = true;
+  return 0;
+}
+
+
+static int run_cooperative() {
+
+  static Executor executor;
+  const char base = 0;
+  stack_basep = &base;
+  for (unsigned i = 0; i < NUM_NODES; ++i) {
+    nodes.setup(i);
+    executor.add(*nodes.nodeps[i]);
+  }
+
+  static Publishers pubs;
+  if (!publish_all(pubs, &executor)) return 1;
+  print("cooperative", 1,
+        NUM_NODES * sizeof(r2p::Node) + sizeof(executor));
+  return 0;
+}
+
+
+static bool run(int (*runf)()) {
+
+  pid_t child = fork();
+  if (child < 0) return false;
+  if (child == 0) {
+    r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                         r2p::Thread::LOWEST);
+    r2p::Middleware::instance.start();
+
+    // The middleware threads never end, leave without destroying them
+    const int rc = runf();
+    fflush(stdout);
+    _exit(rc);
+  }
+  int status;
+  return waitpid(child, &status, 0) == child && WIFEXITED(status) &&
+         WEXITSTATUS(status) == 0;
+}
+
+
+int main() {
+
+  printf("%u nodes, %u messages per topic, bytes on this host\n",
+         static_cast<unsigned>(NUM_NODES), static_cast<unsigned>(NUM_MSGS));
+  printf("%-12s %7s %7s %12s %7s %8s\n", "mode", "threads", "stacks",
+         "nodes+exec", "total", "deepest");
+  fflush(stdout);
+
+  bool ok = run(run_threads);
+  ok = run(run_cooperative) && ok;
+  if (!ok) {
+    printf("FAILED: messages lost\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,97 @@
+// CRC-16-CCITT and CRC-32C throughput over 16-byte and 1 KiB chunks. The
+// CRC-32C engine is the one selected at build time: the Makefile builds
+// this bench once per engine. The check values of "123456789" and a byte
+// at a time reference over odd lengths and offsets are verified first.
+
+#include <r2p/common.hpp>
+#include <r2p/Crc.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+
+enum { BUFFER_LENGTH = 1 << 10 };
+enum { TOTAL_LENGTH = 1 << 26 };  // Per measurement
+
+#if R2P_CRC_USE_SSE42
+static const char *const ENGINE = "sse4.2";
+#elif R2P_CRC_USE_SLICE_BY_8
+static const char *const ENGINE = "slice-by-8";
+#else
+static const char *const ENGINE = "table";
+#endif
+
+static uint8_t buffer[BUFFER_LENGTH + 8];
+
+
+static uint64_t now_ns() {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+}
+
+
+static bool check() {
+
+  static const char digits[] = "123456789";
+  r2p::Crc16 crc16;
+  crc16.add(digits, sizeof(digits) - 1);
+  r2p::Crc32c crc32c;
+  crc32c.add(digits, sizeof(digits) - 1);
+  bool ok = crc16.check(0x29B1) && crc32c.check(0xE3069283);
+
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t length = 0; length < 40; ++length) {
+      r2p::Crc16 chunk16, byte16;
+      r2p::Crc32c chunk32, byte32;
+      chunk16.add(buffer + offset, length);
+      chunk32.add(buffer + offset, length);
+      for (size_t i = 0; i < length; ++i) {
+        byte16.add(buffer[offset + i]);
+        byte32.add(buffer[offset + i]);
+      }
+      ok = ok && chunk16.check(byte16.compute_checksum()) &&
+           chunk32.check(byte32.compute_checksum());
+    }
+  }
+  return ok;
+}
+
+
+// Returns MB/s
+template<typename Crc>
+static double run(size_t chunk_length) {
+
+  Crc crc;
+  const uint64_t start = now_ns();
+  for (size_t done = 0; done < TOTAL_LENGTH; done += chunk_length) {
+    crc.add(buffer, chunk_length);
+  }
+  const uint64_t elapsed = now_ns() - start;
+
+  // Keep the result alive
+  volatile typename Crc::Type checksum = crc.compute_checksum();
+  (void)checksum;
+  return TOTAL_LENGTH / (elapsed / 1e3);
+}
+
+
+int main() {
+
+  for (size_t i = 0; i < sizeof(buffer); ++i) {
+    buffer[i] = static_cast<uint8_t>(i * 131 + 7);
+  }
+  if (!check()) {
+    printf("FAILED: %s checksums\n", ENGINE);
+    return EXIT_FAILURE;
+  }
+
+  printf("CRC-32C engine: %s, MB/s\n", ENGINE);
+  printf("%-8s %10s %10s\n", "crc", "16 B", "1 KiB");
+  printf("%-8s %10.1f %10.1f\n", "crc16",
+         run<r2p::Crc16>(16), run<r2p::Crc16>(BUFFER_LENGTH));
+  printf("%-8s %10.1f %10.1f\n", "crc32c",
+         run<r2p::Crc32c>(16), run<r2p::Crc32c>(BUFFER_LENGTH));
+  return EXIT_SUCCESS;
+}
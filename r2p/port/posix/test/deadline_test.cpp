@@ -0,0 +1,157 @@
+// Earliest deadline first dispatch of Node::spin(): topics with different
+// publish timeouts, subscribed in another order than their deadlines, must
+// call back by increasing slack, topics without a timeout last. Messages
+// older than their publish timeout are dropped and counted as expired.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/Publisher.hpp>
+#include <r2p/Subscriber.hpp>
+#include <r2p/Topic.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+struct IdMsg : public r2p::Message {
+  uint64_t id;
+} R2P_PACKED;
+
+// Subscribed in this order, none of them by deadline
+enum { NONE, SLOW, FAST, MID, STALE, NUM_TOPICS };
+enum { QUEUE_LENGTH = 2 };
+enum { MAX_CALLS = 8 };
+enum { STACKLEN = 1024 };
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("TEST", "BOOT_TEST"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t mgmt_stack[STACKLEN];
+
+static const char *const names[NUM_TOPICS] = {
+  "none", "slow", "fast", "mid", "stale"
+};
+static const char *const labels = "NSFMX";
+
+static char calls[MAX_CALLS + 1];
+static size_t num_calls = 0;
+
+
+static bool id_cb(const IdMsg &msg) {
+
+  if (num_calls < MAX_CALLS) {
+    calls[num_calls] = labels[msg.id];
+  }
+  ++num_calls;
+  return true;
+}
+
+
+class IdSubscriber : public r2p::Subscriber<IdMsg, QUEUE_LENGTH> {
+public:
+  IdSubscriber() : r2p::Subscriber<IdMsg, QUEUE_LENGTH>(id_cb) {}
+};
+
+static IdSubscriber subs[NUM_TOPICS];
+static r2p::Publisher<IdMsg> pubs[NUM_TOPICS];
+
+
+static bool check(bool condition, const char *whatp) {
+
+  if (!condition) {
+    printf("FAILED: %s\n", whatp);
+  }
+  return condition;
+}
+
+
+static bool publish(unsigned topic) {
+
+  IdMsg *msgp;
+  if (!pubs[topic].alloc(msgp)) return check(false, "alloc");
+  msgp->id = topic;
+  pubs[topic].publish(*msgp);
+  return true;
+}
+
+
+// Dispatches everything, then compares the callbacks with the expected order
+static bool expect(r2p::Node &node, const char *orderp, const char *whatp) {
+
+  while (node.spin(r2p::Time::IMMEDIATE)) {}
+  if (num_calls > MAX_CALLS) num_calls = MAX_CALLS;
+  calls[num_calls] = 0;
+  const bool ok = strcmp(calls, orderp) == 0;
+  if (!ok) {
+    printf("%s: called back %s, expected %s\n", whatp, calls, orderp);
+  }
+  num_calls = 0;
+  return check(ok, whatp);
+}
+
+
+int main() {
+
+  r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                       r2p::Thread::LOWEST);
+  r2p::Middleware::instance.start();
+
+  static const r2p::Time timeouts[NUM_TOPICS] = {
+    r2p::Time::INFINITE, r2p::Time::s(10), r2p::Time::ms(100),
+    r2p::Time::ms(200), r2p::Time::ms(20)
+  };
+  r2p::Node &node = *new r2p::Node("test");
+  for (unsigned i = 0; i < NUM_TOPICS; ++i) {
+    if (!node.subscribe(subs[i], names[i]) ||
+        !node.advertise(pubs[i], names[i], timeouts[i])) {
+      check(false, "subscribe");
+      fflush(stdout);
+      _exit(EXIT_FAILURE);
+    }
+  }
+
+  // Published at once: the tightest timeout first, no timeout last
+  bool ok = publish(SLOW) && publish(NONE) && publish(MID) && publish(FAST);
+  ok = expect(node, "FMSN", "by publish timeout") && ok;
+
+  // The slack left decides, not the timeout: MID has waited for most of its
+  // 200 ms when FAST gets its 100 ms
+  ok = publish(NONE) && publish(MID) && ok;
+  r2p::Thread::sleep(r2p::Time::ms(120));
+  ok = publish(FAST) && ok;
+  ok = expect(node, "MFN", "by slack left") && ok;
+
+  // Past their 20 ms, dropped without a callback and back to the pool
+  ok = publish(STALE) && publish(STALE) && ok;
+  r2p::Thread::sleep(r2p::Time::ms(50));
+  ok = expect(node, "", "stale messages dropped") && ok;
+  ok = check(subs[STALE].get_num_expired() == 2, "expired count") && ok;
+  ok = check(pubs[STALE].get_topic()->get_num_allocated() == 0,
+             "stale messages back in the pool") && ok;
+
+  // In time again, the tighter slack first
+  ok = publish(FAST) && publish(STALE) && ok;
+  ok = expect(node, "XF", "fresh messages delivered") && ok;
+  for (unsigned i = 0; i < NUM_TOPICS; ++i) {
+    ok = check(subs[i].get_num_expired() == ((i == STALE) ? 2u : 0u),
+               "no other topic expired") && ok;
+  }
+
+  if (ok) {
+    printf("OK\n");
+  }
+  fflush(stdout);
+
+  // The middleware threads never end, leave without destroying them
+  _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,268 @@
+// DebugTransport between two processes joined by a pty: round trip time of
+// a ping answered by the peer, then the rate of a one-way flood, first with
+// the default ASCII frames, then with both sides opted in to binary frames.
+// The CPU time of the flooding process, whose TX thread packs the frames, is
+// reported per flood message.
+// The ChibiOS channel calls are mapped onto the pty by chibios/io_channel.h.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/NamingTraits.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/Publisher.hpp>
+#include <r2p/Subscriber.hpp>
+#include <r2p/transport/DebugTransport.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+struct BenchMsg : public r2p::Message {
+  uint64_t value;
+  uint8_t  data[24];
+} R2P_PACKED;
+
+enum { NUM_PINGS = 200 };
+enum { NUM_FLOOD = 1 << 12 };
+enum { QUEUE_LENGTH = 16 };
+enum { STACKLEN = 1024 };
+
+// Asks the peer for the number of flood messages it got
+static const uint64_t FLOOD_QUERY = ~static_cast<uint64_t>(0);
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("HOST", "BOOT_HOST"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t mgmt_stack[STACKLEN];
+static uint8_t rx_stack[STACKLEN];
+static uint8_t tx_stack[STACKLEN];
+
+static BaseChannel channel;
+static char namebuf[r2p::NamingTraits<r2p::Topic>::MAX_LENGTH];
+
+// Node, subscribers and publishers outlive the transport threads
+static r2p::Node *nodep;
+static r2p::Publisher<BenchMsg> ping_pub, pong_pub, flood_pub;
+static volatile uint64_t last_pong = 0;
+static uint64_t num_flood = 0;
+
+
+static uint64_t now_ns(clockid_t clock = CLOCK_MONOTONIC) {
+
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+}
+
+
+static void send(r2p::Publisher<BenchMsg> &pub, uint64_t value) {
+
+  BenchMsg *msgp;
+  while (!pub.alloc(msgp)) {
+    r2p::Thread::yield();
+  }
+  msgp->value = value;
+  memset(msgp->data, 0x5A, sizeof(msgp->data));
+  pub.publish(*msgp);
+}
+
+
+static bool ping_cb(const BenchMsg &msg) {
+
+  send(pong_pub, (msg.value == FLOOD_QUERY) ? num_flood : msg.value);
+  return true;
+}
+
+
+static bool pong_cb(const BenchMsg &msg) {
+
+  last_pong = msg.value;
+  return true;
+}
+
+
+static bool flood_cb(const BenchMsg &msg) {
+
+  (void)msg;
+  ++num_flood;
+  return true;
+}
+
+
+static void start(int fd, bool binary) {
+
+  r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                       r2p::Thread::LOWEST);
+
+  channel.fd = fd;
+  static r2p::DebugTransport debugtra("DEBUG", &channel, namebuf);
+  debugtra.set_binary_enabled(binary);
+  debugtra.initialize(rx_stack, sizeof(rx_stack), r2p::Thread::NORMAL,
+                      tx_stack, sizeof(tx_stack), r2p::Thread::NORMAL);
+
+  r2p::Middleware::instance.start();
+}
+
+
+// Spins until the pong carrying the value arrives
+static bool wait_pong(uint64_t value, const r2p::Time &timeout) {
+
+  const r2p::Time deadline = r2p::Time::now() + timeout;
+  while (last_pong != value) {
+    if (r2p::Time::now() >= deadline) return false;
+    nodep->spin(r2p::Time::ms(10));
+  }
+  return true;
+}
+
+
+static int run_echo(int fd, bool binary) {
+
+  start(fd, binary);
+
+  static r2p::Subscriber<BenchMsg, QUEUE_LENGTH> ping_sub(ping_cb);
+  static r2p::Subscriber<BenchMsg, QUEUE_LENGTH> flood_sub(flood_cb);
+  nodep = new r2p::Node("echo");
+  nodep->advertise(pong_pub, "pong");
+  nodep->subscribe(ping_sub, "ping");
+  nodep->subscribe(flood_sub, "flood");
+  for (;;) {
+    nodep->spin(r2p::Time::ms(100));
+  }
+  return 0;
+}
+
+
+static int run_measure(int fd, bool binary) {
+
+  start(fd, binary);
+
+  static r2p::Subscriber<BenchMsg, QUEUE_LENGTH> pong_sub(pong_cb);
+  nodep = new r2p::Node("measure");
+  nodep->advertise(ping_pub, "ping");
+  nodep->advertise(flood_pub, "flood");
+  nodep->subscribe(pong_sub, "pong");
+
+  // Ping until the peer has subscribed and answers
+  bool linked = false;
+  for (unsigned i = 0; i < 100 && !linked; ++i) {
+    send(ping_pub, 1);
+    linked = wait_pong(1, r2p::Time::ms(100));
+  }
+  if (!linked) return 1;
+  r2p::Thread::sleep(r2p::Time::ms(200));
+
+  uint64_t start = now_ns();
+  for (uint64_t i = 2; i < NUM_PINGS + 2; ++i) {
+    send(ping_pub, i);
+    if (!wait_pong(i, r2p::Time::s(1))) return 1;
+  }
+  const double rtt_us = (now_ns() - start) / 1e3 / NUM_PINGS;
+
+  // The pool of the flood topic throttles the publisher to the TX thread,
+  // losses happen on the receiving side only
+  start = now_ns();
+  const uint64_t cpu_start = now_ns(CLOCK_PROCESS_CPUTIME_ID);
+  for (unsigned i = 0; i < NUM_FLOOD; ++i) {
+    send(flood_pub, i);
+  }
+  r2p::Thread::sleep(r2p::Time::ms(10));
+  const double cpu_us = (now_ns(CLOCK_PROCESS_CPUTIME_ID) - cpu_start) /
+                        1e3 / NUM_FLOOD;
+  last_pong = 0;
+  bool answered = false;
+  uint64_t received = 0;
+  for (unsigned i = 0; i < 100 && !answered; ++i) {
+    send(ping_pub, FLOOD_QUERY);
+    const r2p::Time deadline = r2p::Time::now() + r2p::Time::ms(100);
+    while (last_pong == 0 && r2p::Time::now() < deadline) {
+      nodep->spin(r2p::Time::ms(10));
+    }
+    received = last_pong;
+    answered = received > 0;
+  }
+  const double seconds = (now_ns() - start) / 1e9;
+  if (!answered) return 1;
+
+  printf("%-6s %10.1f %12.1f %11.2f %9u/%u\n", binary ? "binary" : "ascii",
+         rtt_us, received / seconds / 1e3, cpu_us,
+         static_cast<unsigned>(received), static_cast<unsigned>(NUM_FLOOD));
+  return 0;
+}
+
+
+// Raw pty: no echo, no line discipline, bytes pass through unchanged
+static bool open_pty(int &master, int &slave) {
+
+  master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0) return false;
+  if (grantpt(master) != 0 || unlockpt(master) != 0) return false;
+  slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  if (slave < 0) return false;
+
+  struct termios tio;
+  if (tcgetattr(slave, &tio) != 0) return false;
+  cfmakeraw(&tio);
+  return tcsetattr(slave, TCSANOW, &tio) == 0;
+}
+
+
+static bool run(bool binary) {
+
+  pid_t runner = fork();
+  if (runner < 0) return false;
+  if (runner == 0) {
+    int master, slave;
+    if (!open_pty(master, slave)) _exit(2);
+    pid_t echo = fork();
+    if (echo < 0) _exit(2);
+    if (echo == 0) {
+      close(master);
+
+      // The middleware threads never end, leave without destroying them
+      _exit(run_echo(slave, binary));
+    }
+    close(slave);
+    int rc = run_measure(master, binary);
+    fflush(stdout);
+    kill(echo, SIGKILL);
+    waitpid(echo, NULL, 0);
+    _exit(rc);
+  }
+  int status;
+  return waitpid(runner, &status, 0) == runner && WIFEXITED(status) &&
+         WEXITSTATUS(status) == 0;
+}
+
+
+int main() {
+
+  printf("%u-byte messages, %u pings, %u flood messages\n",
+         static_cast<unsigned>(sizeof(BenchMsg) - sizeof(r2p::Message)),
+         static_cast<unsigned>(NUM_PINGS), static_cast<unsigned>(NUM_FLOOD));
+  printf("%-6s %10s %12s %11s %15s\n", "frames", "rtt us", "flood kmsg/s",
+         "cpu us/msg", "received");
+  fflush(stdout);
+
+  bool ok = run(false);
+  ok = run(true) && ok;
+  if (!ok) {
+    printf("FAILED: no answer from the peer\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+// Executor benchmark: 8 nodes with one subscriber each, fed round robin by
+// the main thread and run by 1, 2, 4 and 8 worker threads. Each worker count
+// runs in its own process, as nodes cannot leave an executor.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/Executor.hpp>
+#include <r2p/Publisher.hpp>
+#include <r2p/Subscriber.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+struct BenchMsg : public r2p::Message {
+  uint64_t value;
+} R2P_PACKED;
+
+enum { NUM_NODES = 8 };
+enum { MAX_WORKERS = 8 };
+enum { NUM_MSGS = 1 << 16 };
+enum { QUEUE_LENGTH = 8 };
+enum { WORK_LOOPS = 500 }; // Callback cost, a few microseconds
+enum { STACKLEN = 1024 };
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("BENCH", "BOOT_BENCH"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static const char *const topic_names[NUM_NODES] = {
+  "bench0", "bench1", "bench2", "bench3",
+  "bench4", "bench5", "bench6", "bench7"
+};
+
+static const char *const node_names[NUM_NODES] = {
+  "node0", "node1", "node2", "node3", "node4", "node5", "node6", "node7"
+};
+
+static uint8_t mgmt_stack[STACKLEN];
+static uint8_t worker_stacks[MAX_WORKERS][STACKLEN];
+
+// Written only by the callbacks of one node, which never run concurrently
+static volatile uint32_t num_received[NUM_NODES];
+static volatile uint32_t sink;
+
+
+template<unsigned INDEX>
+static bool bench_cb(const BenchMsg &msg) {
+
+  uint32_t acc = static_cast<uint32_t>(msg.value);
+  for (unsigned i = 0; i < WORK_LOOPS; ++i) {
+    acc = acc * 1664525u + 1013904223u;
+  }
+  sink = acc;
+  num_received[INDEX] = num_received[INDEX] + 1;
+  return true;
+}
+
+
+static bool (*const callbacks[NUM_NODES])(const BenchMsg &) = {
+  bench_cb<0>, bench_cb<1>, bench_cb<2>, bench_cb<3>,
+  bench_cb<4>, bench_cb<5>, bench_cb<6>, bench_cb<7>
+};
+
+
+static uint32_t count_received() {
+
+  uint32_t total = 0;
+  for (unsigned i = 0; i < NUM_NODES; ++i) {
+    total += num_received[i];
+  }
+  return total;
+}
+
+
+static int run(size_t num_workers) {
+
+  r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                       r2p::Thread::LOWEST);
+  r2p::Middleware::instance.start();
+
+  static r2p::Node *queue_bufs[MAX_WORKERS][NUM_NODES];
+  static r2p::Executor::Worker *workers[MAX_WORKERS];
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers[i] = new r2p::Executor::Worker(queue_bufs[i], NUM_NODES);
+  }
+  r2p::Executor executor(workers, num_workers);
+
+  r2p::Node *nodes[NUM_NODES];
+  r2p::Subscriber<BenchMsg, QUEUE_LENGTH> *subs[NUM_NODES];
+  for (unsigned i = 0; i < NUM_NODES; ++i) {
+    nodes[i] = new r2p::Node(node_names[i]);
+    subs[i] = new r2p::Subscriber<BenchMsg, QUEUE_LENGTH>(callbacks[i]);
+    nodes[i]->subscribe(*subs[i], topic_names[i]);
+    executor.add(*nodes[i]);
+  }
+
+  r2p::Node pub_node("pub");
+  r2p::Publisher<BenchMsg> pubs[NUM_NODES];
+  for (unsigned i = 0; i < NUM_NODES; ++i) {
+    pub_node.advertise(pubs[i], topic_names[i]);
+  }
+
+  for (size_t i = 0; i < num_workers; ++i) {
+    if (!executor.start(i, worker_stacks[i], STACKLEN, r2p::Thread::NORMAL)) {
+      return 2;
+    }
+  }
+
+  // The pools hold as many messages as the queues, so a publisher waits
+  // for its node to catch up instead of dropping
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint32_t n = 0; n < NUM_MSGS; ++n) {
+    r2p::Publisher<BenchMsg> &pub = pubs[n % NUM_NODES];
+    BenchMsg *msgp;
+    while (!pub.alloc(msgp)) {
+      r2p::Thread::yield();
+    }
+    msgp->value = n;
+    pub.publish(*msgp);
+  }
+  const r2p::Time deadline = r2p::Time::now() + r2p::Time::s(10);
+  while (count_received() < NUM_MSGS && r2p::Time::now() < deadline) {
+    r2p::Thread::yield();
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  executor.stop();
+
+  const double seconds = (end.tv_sec - start.tv_sec) +
+                         (end.tv_nsec - start.tv_nsec) / 1e9;
+  const uint32_t received = count_received();
+  printf("%7u %12.1f %10u\n", static_cast<unsigned>(num_workers),
+         received / seconds / 1e3, static_cast<unsigned>(received));
+  return (received == NUM_MSGS) ? 0 : 1;
+}
+
+
+int main() {
+
+  printf("%u nodes, %u messages, ~%u loops per callback\n",
+         static_cast<unsigned>(NUM_NODES), static_cast<unsigned>(NUM_MSGS),
+         static_cast<unsigned>(WORK_LOOPS));
+  printf("%7s %12s %10s\n", "workers", "kmsg/s", "received");
+  fflush(stdout);
+
+  bool ok = true;
+  for (size_t num_workers = 1; num_workers <= MAX_WORKERS; num_workers *= 2) {
+    pid_t child = fork();
+    if (child < 0) return EXIT_FAILURE;
+    if (child == 0) {
+      // The middleware threads never end, leave without destroying them
+      int rc = run(num_workers);
+      fflush(stdout);
+      _exit(rc);
+    }
+    int status;
+    ok = waitpid(child, &status, 0) == child && WIFEXITED(status) &&
+         WEXITSTATUS(status) == 0 && ok;
+  }
+  if (!ok) {
+    printf("FAILED: messages lost\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
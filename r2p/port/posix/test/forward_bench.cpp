@@ -0,0 +1,164 @@
+// Management pool usage when a bridge forwards a burst of messages to 1, 2,
+// 4 and 8 transports. Topic::forward_copy() shares the messages whose
+// contents are the same for every transport (STOP here), and copies the
+// PubSub ones (ADVERTISE here), whose raw parameters are per transport.
+// The transports are stubs that only queue, so the peak is read after the
+// whole burst is forwarded.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/MgmtMsg.hpp>
+#include <r2p/RemoteSubscriber.hpp>
+#include <r2p/Topic.hpp>
+#include <r2p/Transport.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+enum { MAX_TRANSPORTS = 8 };
+enum { QUEUE_LENGTH = 16 };
+enum { BURST_LENGTH = 8 };
+enum { MSGPOOL_LENGTH = QUEUE_LENGTH };
+enum { STACKLEN = 1024 };
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("BENCH", "BOOT_BENCH"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t mgmt_stack[STACKLEN];
+
+
+class StubSubscriber : public r2p::RemoteSubscriber {
+public:
+  StubSubscriber(r2p::Transport &transport,
+                 r2p::TimestampedMsgPtrQueue::Entry queue_buf[])
+  :
+    r2p::RemoteSubscriber(transport, queue_buf, QUEUE_LENGTH)
+  {}
+};
+
+
+// Subscribes to the management topic only, and never sends
+class StubTransport : public r2p::Transport {
+private:
+  r2p::TimestampedMsgPtrQueue::Entry queue_buf[QUEUE_LENGTH];
+  r2p::MgmtMsg msgpool_buf[MSGPOOL_LENGTH];
+  StubSubscriber sub;
+
+public:
+  bool attach() {
+    return subscribe(sub, r2p::Middleware::instance.get_mgmt_topic().get_name(),
+                     msgpool_buf, MSGPOOL_LENGTH, sizeof(r2p::MgmtMsg));
+  }
+
+  size_t drain(r2p::Topic &topic) {
+    size_t count = 0;
+    r2p::Message *msgp;
+    r2p::Time timestamp;
+    while (sub.fetch(msgp, timestamp)) {
+      topic.release(*msgp);
+      ++count;
+    }
+    return count;
+  }
+
+private:
+  r2p::RemotePublisher *create_publisher(r2p::Topic &topic,
+                                         const uint8_t raw_params[]) const {
+    (void)topic;
+    (void)raw_params;
+    return NULL;
+  }
+
+  r2p::RemoteSubscriber *create_subscriber(
+    r2p::Topic &topic,
+    r2p::TimestampedMsgPtrQueue::Entry queue_buf[],
+    size_t queue_length) const {
+    (void)topic;
+    (void)queue_buf;
+    (void)queue_length;
+    return NULL;
+  }
+
+public:
+  StubTransport() : r2p::Transport("STUB"), sub(*this, queue_buf) {}
+};
+
+
+// Returns the messages in use once the burst is forwarded, or 0 on failure
+static size_t forward_burst(r2p::Topic &topic, StubTransport transports[],
+                            size_t num_transports,
+                            r2p::MgmtMsg::TypeEnum type) {
+
+  r2p::MgmtMsg *msgps[BURST_LENGTH];
+  for (unsigned i = 0; i < BURST_LENGTH; ++i) {
+    if (!topic.alloc(msgps[i])) return 0;
+    r2p::Message::reset_payload(*msgps[i]);
+    msgps[i]->type = type;
+    strncpy(msgps[i]->module.name, "OTHER",
+            r2p::NamingTraits<r2p::Middleware>::MAX_LENGTH);
+    msgps[i]->acquire();
+    if (!topic.forward_copy(*msgps[i], topic.compute_deadline())) return 0;
+  }
+  const size_t peak = topic.get_num_allocated();
+
+  // Drop the references of the mgmt thread, then send everything
+  for (unsigned i = 0; i < BURST_LENGTH; ++i) {
+    topic.release(*msgps[i]);
+  }
+  size_t count = 0;
+  for (size_t i = 0; i < num_transports; ++i) {
+    count += transports[i].drain(topic);
+  }
+  if (count != num_transports * BURST_LENGTH) return 0;
+  if (topic.get_num_allocated() != 0) return 0;
+  return peak;
+}
+
+
+int main() {
+
+  // The management thread is not started, the topic is used directly
+  r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                       r2p::Thread::LOWEST);
+  r2p::Topic &topic = r2p::Middleware::instance.get_mgmt_topic();
+  static StubTransport transports[MAX_TRANSPORTS];
+
+  printf("%u forwarded messages, peak management messages in use\n",
+         static_cast<unsigned>(BURST_LENGTH));
+  printf("%10s %10s %10s\n", "transports", "shared", "copied");
+
+  bool ok = true;
+  size_t num_transports = 0;
+  for (size_t target = 1; target <= MAX_TRANSPORTS; target *= 2) {
+    while (num_transports < target) {
+      if (!transports[num_transports++].attach()) return EXIT_FAILURE;
+    }
+    const size_t shared = forward_burst(topic, transports, num_transports,
+                                        r2p::MgmtMsg::STOP);
+    const size_t copied = forward_burst(topic, transports, num_transports,
+                                        r2p::MgmtMsg::ADVERTISE);
+    ok = ok && shared > 0 && copied > 0;
+    printf("%10u %10u %10u\n", static_cast<unsigned>(num_transports),
+           static_cast<unsigned>(shared), static_cast<unsigned>(copied));
+  }
+#if R2P_USE_TRAFFIC_COUNTERS
+  printf("pool high-water mark: %u\n",
+         static_cast<unsigned>(topic.get_counters().max_pool_usage));
+#endif
+
+  if (!ok) {
+    printf("FAILED: messages lost\n");
+  }
+  fflush(stdout);
+  _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
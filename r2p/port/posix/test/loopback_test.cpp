@@ -0,0 +1,319 @@
+// Two processes linked by the transport named on the command line: the
+// parent publishes a counter, the child subscribes to it and checks that the
+// values arrive in order. Exits with 0 on success.
+// With "saturate", the parent instead floods a bulk topic without deadline
+// while it publishes a topic with a tight one; the child checks that the
+// tight messages still arrive in time.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/Publisher.hpp>
+#include <r2p/Subscriber.hpp>
+#include <r2p/transport/UdpTransport.hpp>
+#include <r2p/transport/ShmTransport.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Pool blocks must hold a pointer, as on ChibiOS
+struct CounterMsg : public r2p::Message {
+  uint64_t value;
+} R2P_PACKED;
+
+struct StampMsg : public r2p::Message {
+  uint64_t seq;
+  uint64_t sent_ns;
+} R2P_PACKED;
+
+struct BulkMsg : public r2p::Message {
+  uint64_t sent_ns;
+  uint8_t  data[192];
+} R2P_PACKED;
+
+enum { NUM_MSGS = 50 };
+enum { NUM_TIGHT = 500 };
+enum { TIGHT_PERIOD_MS = 2 };
+enum { TIGHT_TIMEOUT_MS = 10 };
+enum { BULK_QUEUE_LENGTH = 32 };
+enum { STACKLEN = 1024 };
+
+static const char *const GROUP_ADDR = "239.255.82.50";
+static const uint16_t GROUP_PORT = 24000;
+static const char *const SHM_NAME = "/r2p_loopback_test";
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("HOST", "BOOT_HOST"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t mgmt_stack[STACKLEN];
+static uint8_t rx_stack[STACKLEN];
+static uint8_t tx_stack[STACKLEN];
+
+static uint32_t num_received = 0;
+static uint64_t last_value = 0;
+static bool in_order = true;
+
+struct LatencyStats {
+  uint32_t count;
+  uint32_t on_time;
+  uint64_t sum_ns;
+  uint64_t max_ns;
+};
+
+static LatencyStats tight_stats;
+static LatencyStats bulk_stats;
+
+
+static uint64_t now_ns() {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+}
+
+
+static void update(LatencyStats &stats, uint64_t sent_ns) {
+
+  const uint64_t latency_ns = now_ns() - sent_ns;
+  ++stats.count;
+  if (latency_ns <= TIGHT_TIMEOUT_MS * 1000000ull) ++stats.on_time;
+  stats.sum_ns += latency_ns;
+  if (latency_ns > stats.max_ns) stats.max_ns = latency_ns;
+}
+
+
+static void print(const char *namep, const LatencyStats &stats) {
+
+  const double count = (stats.count > 0) ? stats.count : 1;
+  printf("  %-6s %6u msgs, latency avg %6.2f ms, max %6.2f ms, "
+         "%5.1f%% within %u ms\n", namep,
+         static_cast<unsigned>(stats.count), stats.sum_ns / count / 1e6,
+         stats.max_ns / 1e6, 100.0 * stats.on_time / count,
+         static_cast<unsigned>(TIGHT_TIMEOUT_MS));
+}
+
+
+static bool counter_cb(const CounterMsg &msg) {
+
+  if (num_received > 0 && msg.value <= last_value) {
+    in_order = false;
+  }
+  last_value = msg.value;
+  ++num_received;
+  return true;
+}
+
+
+static bool tight_cb(const StampMsg &msg) {
+
+  update(tight_stats, msg.sent_ns);
+  return true;
+}
+
+
+static bool bulk_cb(const BulkMsg &msg) {
+
+  update(bulk_stats, msg.sent_ns);
+  return true;
+}
+
+
+static bool start(const char *kindp, bool parent) {
+
+  r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                       r2p::Thread::LOWEST);
+
+  bool success = false;
+  if (strcmp(kindp, "udp") == 0) {
+    static r2p::UdpTransport udptra("UDP", GROUP_ADDR, GROUP_PORT,
+                                    parent ? 24001 : 24002);
+    success = udptra.initialize(rx_stack, sizeof(rx_stack),
+                                r2p::Thread::NORMAL,
+                                tx_stack, sizeof(tx_stack),
+                                r2p::Thread::NORMAL);
+  } else if (strcmp(kindp, "shm") == 0) {
+    static r2p::ShmTransport shmtra("SHM", SHM_NAME,
+                                    parent ? r2p::ShmTransport::SIDE_A
+                                           : r2p::ShmTransport::SIDE_B);
+    success = shmtra.initialize(rx_stack, sizeof(rx_stack),
+                                r2p::Thread::NORMAL,
+                                tx_stack, sizeof(tx_stack),
+                                r2p::Thread::NORMAL);
+  }
+  if (!success) return false;
+
+  r2p::Middleware::instance.start();
+  return true;
+}
+
+
+static int run_subscriber(const char *kindp) {
+
+  if (!start(kindp, false)) return 2;
+
+  // Still in use by the transport threads once this returns
+  static r2p::Node node("sub");
+  static r2p::Subscriber<CounterMsg, 8> sub(counter_cb);
+  node.subscribe(sub, "counter");
+
+  const r2p::Time deadline = r2p::Time::now() + r2p::Time::s(10);
+  while (num_received < NUM_MSGS && r2p::Time::now() < deadline) {
+    node.spin(r2p::Time::ms(100));
+  }
+
+  printf("%s: %u messages received, %s\n", kindp,
+         static_cast<unsigned>(num_received),
+         in_order ? "in order" : "OUT OF ORDER");
+  return (num_received >= NUM_MSGS && in_order) ? 0 : 1;
+}
+
+
+static int run_saturated_subscriber(const char *kindp) {
+
+  if (!start(kindp, false)) return 2;
+
+  // Still in use by the transport threads once this returns
+  static r2p::Node node("sub");
+  static r2p::Subscriber<StampMsg, 8> tight_sub(tight_cb);
+  static r2p::Subscriber<BulkMsg, BULK_QUEUE_LENGTH> bulk_sub(bulk_cb);
+  node.subscribe(tight_sub, "tight");
+  node.subscribe(bulk_sub, "bulk");
+
+  const r2p::Time deadline = r2p::Time::now() + r2p::Time::s(10);
+  while (tight_stats.count < NUM_TIGHT && r2p::Time::now() < deadline) {
+    node.spin(r2p::Time::ms(100));
+  }
+
+  printf("%s saturated:\n", kindp);
+  print("tight", tight_stats);
+  print("bulk", bulk_stats);
+
+  // Most tight messages in time, while the bulk ones keep the link busy
+  const bool ok = tight_stats.count >= NUM_TIGHT &&
+                  tight_stats.on_time >= tight_stats.count * 9 / 10 &&
+                  bulk_stats.count >= tight_stats.count;
+  return ok ? 0 : 1;
+}
+
+
+// The counter every 10 ms
+static void publish_counter() {
+
+  static r2p::Node node("pub");
+  static r2p::Publisher<CounterMsg> pub;
+  static uint64_t value = 0;
+  if (value == 0) {
+    node.advertise(pub, "counter");
+  }
+
+  CounterMsg *msgp;
+  if (pub.alloc(msgp)) {
+    msgp->value = ++value;
+    pub.publish(*msgp);
+  }
+  r2p::Thread::sleep(r2p::Time::ms(10));
+}
+
+
+// The tight topic when due, the bulk one as fast as its pool allows
+static void publish_saturating() {
+
+  static r2p::Node node("pub");
+  static r2p::Publisher<StampMsg> tight_pub;
+  static r2p::Publisher<BulkMsg> bulk_pub;
+  static uint64_t seq = 0;
+  static uint64_t next_ns;
+  if (seq == 0) {
+    node.advertise(tight_pub, "tight", r2p::Time::ms(TIGHT_TIMEOUT_MS));
+    node.advertise(bulk_pub, "bulk");
+    next_ns = now_ns();
+    seq = 1;
+  }
+
+  if (now_ns() >= next_ns) {
+    next_ns += TIGHT_PERIOD_MS * 1000000ull;
+    StampMsg *msgp;
+    if (tight_pub.alloc(msgp)) {
+      msgp->seq = seq++;
+      msgp->sent_ns = now_ns();
+      tight_pub.publish(*msgp);
+    }
+    return;
+  }
+  BulkMsg *msgp;
+  if (bulk_pub.alloc(msgp)) {
+    msgp->sent_ns = now_ns();
+    bulk_pub.publish(*msgp);
+  } else {
+    r2p::Thread::yield();
+  }
+}
+
+
+static int run_publisher(const char *kindp, pid_t child, bool saturate) {
+
+  if (!start(kindp, true)) {
+    kill(child, SIGKILL);
+    return 2;
+  }
+
+  // The nodes and publishers are static, still in use by the transport
+  // threads once this returns
+  int status;
+  for (;;) {
+    const pid_t pid = waitpid(child, &status, WNOHANG);
+    if (pid == child) break;
+    if (pid < 0) return 3;
+
+    if (saturate) {
+      publish_saturating();
+    } else {
+      publish_counter();
+    }
+  }
+  // An abort of the child must fail the test too
+  if (!WIFEXITED(status)) {
+    printf("%s: subscriber killed by signal %d\n", kindp,
+           WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+    return 3;
+  }
+  return WEXITSTATUS(status);
+}
+
+
+int main(int argc, char *argv[]) {
+
+  const bool saturate = argc == 3 && strcmp(argv[2], "saturate") == 0;
+  if (argc != 2 && !saturate) {
+    fprintf(stderr, "usage: %s udp|shm [saturate]\n", argv[0]);
+    return 2;
+  }
+
+  pid_t child = fork();
+  if (child < 0) return 2;
+  int rc;
+  if (child == 0) {
+    rc = saturate ? run_saturated_subscriber(argv[1])
+                  : run_subscriber(argv[1]);
+  } else {
+    rc = run_publisher(argv[1], child, saturate);
+  }
+
+  // The middleware threads never end, leave without destroying their objects
+  fflush(stdout);
+  if (child != 0) shm_unlink(SHM_NAME);
+  _exit(rc);
+}
@@ -0,0 +1,145 @@
+// Node::spin() dispatch time against the subscribers of a node: 1, 8 and 32
+// subscribers, each on its own topic. "one ready" signals only the last
+// subscriber, which a walk of the subscriber list would reach last; "all
+// ready" signals every subscriber before the spin. Subscribers are found
+// through the per-node table, one set bit at a time.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/Publisher.hpp>
+#include <r2p/Subscriber.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+#include <unistd.h>
+
+struct BenchMsg : public r2p::Message {
+  uint64_t value;
+} R2P_PACKED;
+
+enum { MAX_SUBSCRIBERS = 32 };
+enum { QUEUE_LENGTH = 2 };
+enum { NUM_ROUNDS = 1 << 14 };
+enum { NAME_LENGTH = 8 };
+enum { STACKLEN = 1024 };
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("BENCH", "BOOT_BENCH"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t mgmt_stack[STACKLEN];
+static unsigned long num_received = 0;
+
+
+static uint64_t now_ns() {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+}
+
+
+static bool bench_cb(const BenchMsg &msg) {
+
+  (void)msg;
+  ++num_received;
+  return true;
+}
+
+
+class BenchSubscriber : public r2p::Subscriber<BenchMsg, QUEUE_LENGTH> {
+public:
+  BenchSubscriber() : r2p::Subscriber<BenchMsg, QUEUE_LENGTH>(bench_cb) {}
+};
+
+
+static bool publish(r2p::Publisher<BenchMsg> &pub) {
+
+  BenchMsg *msgp;
+  if (!pub.alloc(msgp)) return false;
+  msgp->value = 0;
+  pub.publish(*msgp);
+  return true;
+}
+
+
+// Returns the average spin time per message in ns, or a negative value on
+// failure
+static double run(r2p::Node &node, r2p::Publisher<BenchMsg> pubs[],
+                  size_t first, size_t num_pubs) {
+
+  uint64_t elapsed = 0;
+  const unsigned long received = num_received;
+  for (unsigned round = 0; round < NUM_ROUNDS; ++round) {
+    for (size_t i = first; i < first + num_pubs; ++i) {
+      if (!publish(pubs[i])) return -1;
+    }
+    const uint64_t start = now_ns();
+    if (!node.spin(r2p::Time::IMMEDIATE)) return -1;
+    elapsed += now_ns() - start;
+  }
+  if (num_received - received != NUM_ROUNDS * num_pubs) return -1;
+  return static_cast<double>(elapsed) / (NUM_ROUNDS * num_pubs);
+}
+
+
+int main() {
+
+  r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                       r2p::Thread::LOWEST);
+  r2p::Middleware::instance.start();
+
+  static const size_t configs[] = { 1, 8, MAX_SUBSCRIBERS };
+  enum { NUM_CONFIGS = sizeof(configs) / sizeof(configs[0]) };
+  if (static_cast<size_t>(MAX_SUBSCRIBERS) >
+      static_cast<size_t>(r2p::Node::MAX_SUBSCRIBERS)) {
+    _exit(EXIT_FAILURE);
+  }
+
+  printf("%u spins per test, ns per dispatched message\n",
+         static_cast<unsigned>(NUM_ROUNDS));
+  printf("%11s %10s %10s\n", "subscribers", "one ready", "all ready");
+
+  bool ok = true;
+  for (size_t c = 0; c < NUM_CONFIGS; ++c) {
+    const size_t num_subs = configs[c];
+    static char names[NUM_CONFIGS][MAX_SUBSCRIBERS][NAME_LENGTH];
+    static BenchSubscriber subs[NUM_CONFIGS][MAX_SUBSCRIBERS];
+    static r2p::Publisher<BenchMsg> pubs[NUM_CONFIGS][MAX_SUBSCRIBERS];
+
+    r2p::Node *nodep = new r2p::Node("bench");
+    for (size_t i = 0; i < num_subs; ++i) {
+      snprintf(names[c][i], NAME_LENGTH, "n%02u_%02u",
+               static_cast<unsigned>(num_subs), static_cast<unsigned>(i));
+      if (!nodep->subscribe(subs[c][i], names[c][i]) ||
+          !nodep->advertise(pubs[c][i], names[c][i])) {
+        _exit(EXIT_FAILURE);
+      }
+    }
+
+    const double one_ns = run(*nodep, pubs[c], num_subs - 1, 1);
+    const double all_ns = run(*nodep, pubs[c], 0, num_subs);
+    if (one_ns < 0 || all_ns < 0) {
+      ok = false;
+      continue;
+    }
+    printf("%11u %10.1f %10.1f\n", static_cast<unsigned>(num_subs),
+           one_ns, all_ns);
+  }
+  if (!ok) {
+    printf("FAILED: messages lost\n");
+  }
+  fflush(stdout);
+
+  // The middleware threads never end, leave without destroying them
+  _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,168 @@
+// Overflow policies of LocalSubscriber: more messages are published than the
+// queue holds before the node spins, then the delivered values are checked
+// for DROP_NEWEST, DROP_OLDEST and CONFLATE, and every message, evicted ones
+// included, must be back in the pool of its topic.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/Publisher.hpp>
+#include <r2p/Subscriber.hpp>
+#include <r2p/Topic.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+struct ValueMsg : public r2p::Message {
+  uint64_t value;
+} R2P_PACKED;
+
+enum { NUM_POLICIES = 3 };
+enum { QUEUE_LENGTH = 3 };
+enum { NUM_MSGS = 5 };     // Published before each spin
+enum { STACKLEN = 1024 };
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("TEST", "BOOT_TEST"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t mgmt_stack[STACKLEN];
+
+// The queues overflow only if the pools outlast them
+static ValueMsg extra_msgs[NUM_POLICIES][NUM_MSGS];
+
+static uint64_t received[NUM_POLICIES][NUM_MSGS];
+static size_t num_received[NUM_POLICIES];
+
+
+template<unsigned POLICY>
+static bool value_cb(const ValueMsg &msg) {
+
+  if (num_received[POLICY] < NUM_MSGS) {
+    received[POLICY][num_received[POLICY]] = msg.value;
+  }
+  ++num_received[POLICY];
+  return true;
+}
+
+
+static bool check(bool condition, const char *whatp) {
+
+  if (!condition) {
+    printf("FAILED: %s\n", whatp);
+  }
+  return condition;
+}
+
+
+static bool expect(unsigned policy, const uint64_t expected[], size_t count,
+                   const char *whatp) {
+
+  bool ok = num_received[policy] == count;
+  for (size_t i = 0; ok && i < count; ++i) {
+    ok = received[policy][i] == expected[i];
+  }
+  if (!ok) {
+    printf("%s:", whatp);
+    for (size_t i = 0; i < num_received[policy] && i < NUM_MSGS; ++i) {
+      printf(" %u", static_cast<unsigned>(received[policy][i]));
+    }
+    printf("\n");
+  }
+  num_received[policy] = 0;
+  return check(ok, whatp);
+}
+
+
+int main() {
+
+  r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                       r2p::Thread::LOWEST);
+  r2p::Middleware::instance.start();
+
+  static const char *const names[NUM_POLICIES] = {
+    "newest", "oldest", "conflate"
+  };
+  static r2p::Subscriber<ValueMsg, QUEUE_LENGTH>
+    newest_sub(value_cb<0>, r2p::LocalSubscriber::DROP_NEWEST),
+    oldest_sub(value_cb<1>, r2p::LocalSubscriber::DROP_OLDEST),
+    conflate_sub(value_cb<2>, r2p::LocalSubscriber::CONFLATE);
+  r2p::Subscriber<ValueMsg, QUEUE_LENGTH> *const subps[NUM_POLICIES] = {
+    &newest_sub, &oldest_sub, &conflate_sub
+  };
+  static r2p::Publisher<ValueMsg> pubs[NUM_POLICIES];
+
+  r2p::Node &node = *new r2p::Node("test");
+  for (unsigned p = 0; p < NUM_POLICIES; ++p) {
+    if (!node.subscribe(*subps[p], names[p]) ||
+        !node.advertise(pubs[p], names[p])) {
+      check(false, "subscribe");
+      fflush(stdout);
+      _exit(EXIT_FAILURE);
+    }
+    pubs[p].get_topic()->extend_pool(extra_msgs[p], NUM_MSGS);
+  }
+
+  bool ok = true;
+  for (unsigned p = 0; p < NUM_POLICIES; ++p) {
+    for (unsigned i = 0; i < NUM_MSGS; ++i) {
+      ValueMsg *msgp;
+      if (!pubs[p].alloc(msgp)) {
+        ok = check(false, "alloc");
+        break;
+      }
+      msgp->value = i;
+      pubs[p].publish(*msgp);
+    }
+  }
+  while (node.spin(r2p::Time::IMMEDIATE)) {}
+
+  static const uint64_t first[] = { 0, 1, 2 };
+  static const uint64_t last[] = { 2, 3, 4 };
+  static const uint64_t latest[] = { 4 };
+  ok = expect(0, first, QUEUE_LENGTH, "DROP_NEWEST keeps the first") && ok;
+  ok = expect(1, last, QUEUE_LENGTH, "DROP_OLDEST keeps the last") && ok;
+  ok = expect(2, latest, 1, "CONFLATE keeps the latest") && ok;
+  for (unsigned p = 0; p < NUM_POLICIES; ++p) {
+    ok = check(pubs[p].get_topic()->get_num_allocated() == 0,
+               "messages back in the pool") && ok;
+  }
+
+  // Below the queue length only CONFLATE drops anything
+  for (unsigned p = 0; p < NUM_POLICIES; ++p) {
+    for (unsigned i = 0; i < 2; ++i) {
+      ValueMsg *msgp;
+      if (!pubs[p].alloc(msgp)) {
+        ok = check(false, "alloc");
+        break;
+      }
+      msgp->value = i;
+      pubs[p].publish(*msgp);
+    }
+  }
+  while (node.spin(r2p::Time::IMMEDIATE)) {}
+
+  static const uint64_t both[] = { 0, 1 };
+  static const uint64_t second[] = { 1 };
+  ok = expect(0, both, 2, "DROP_NEWEST below the queue length") && ok;
+  ok = expect(1, both, 2, "DROP_OLDEST below the queue length") && ok;
+  ok = expect(2, second, 1, "CONFLATE below the queue length") && ok;
+
+  printf("queue of %u, %u messages per spin\n",
+         static_cast<unsigned>(QUEUE_LENGTH), static_cast<unsigned>(NUM_MSGS));
+  if (ok) {
+    printf("OK\n");
+  }
+  fflush(stdout);
+
+  // The middleware threads never end, leave without destroying them
+  _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
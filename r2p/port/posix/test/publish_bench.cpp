@@ -0,0 +1,149 @@
+// Publish cost against the number of local subscribers of a topic: 1, 4, 16
+// and 64 subscribers, never spun, drained between the timed batches.
+// publish_unsafe() takes the deferred refcount path of
+// Topic::notify_locals_unsafe(), publish() the locking one, which acquires
+// the message once per subscriber.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/Publisher.hpp>
+#include <r2p/Subscriber.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+#include <unistd.h>
+
+struct BenchMsg : public r2p::Message {
+  uint64_t value;
+} R2P_PACKED;
+
+enum { MAX_SUBSCRIBERS = 64 };
+enum { QUEUE_LENGTH = 8 };
+enum { BATCH_LENGTH = QUEUE_LENGTH };
+enum { NUM_ROUNDS = 1 << 12 };
+enum { STACKLEN = 1024 };
+enum { NODES_PER_CONFIG = (MAX_SUBSCRIBERS + r2p::Node::MAX_SUBSCRIBERS - 1) /
+                          r2p::Node::MAX_SUBSCRIBERS };
+
+typedef r2p::Subscriber<BenchMsg, QUEUE_LENGTH> BenchSubscriber;
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("BENCH", "BOOT_BENCH"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t mgmt_stack[STACKLEN];
+
+
+static uint64_t now_ns() {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+}
+
+
+static bool drain(BenchSubscriber subs[], size_t num_subs) {
+
+  size_t count = 0;
+  for (size_t i = 0; i < num_subs; ++i) {
+    BenchMsg *msgp;
+    while (subs[i].fetch(msgp)) {
+      subs[i].release(*msgp);
+      ++count;
+    }
+  }
+  return count == num_subs * BATCH_LENGTH;
+}
+
+
+// Returns the average publish time in ns, or a negative value on failure
+static double run(r2p::Publisher<BenchMsg> &pub, BenchSubscriber subs[],
+                  size_t num_subs, bool unsafe) {
+
+  uint64_t elapsed = 0;
+  for (unsigned round = 0; round < NUM_ROUNDS; ++round) {
+    BenchMsg *msgps[BATCH_LENGTH];
+    for (unsigned i = 0; i < BATCH_LENGTH; ++i) {
+      if (!pub.alloc(msgps[i])) return -1;
+      msgps[i]->value = i;
+    }
+
+    const uint64_t start = now_ns();
+    if (unsafe) {
+      for (unsigned i = 0; i < BATCH_LENGTH; ++i) {
+        r2p::SysLock::acquire();
+        pub.publish_unsafe(*msgps[i]);
+        r2p::SysLock::release();
+      }
+    } else {
+      for (unsigned i = 0; i < BATCH_LENGTH; ++i) {
+        pub.publish(*msgps[i]);
+      }
+    }
+    elapsed += now_ns() - start;
+
+    if (!drain(subs, num_subs)) return -1;
+  }
+  return static_cast<double>(elapsed) / (NUM_ROUNDS * BATCH_LENGTH);
+}
+
+
+int main() {
+
+  r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                       r2p::Thread::LOWEST);
+  r2p::Middleware::instance.start();
+
+  static const size_t configs[] = { 1, 4, 16, MAX_SUBSCRIBERS };
+  static const char *const topic_names[] = {
+    "fanout1", "fanout4", "fanout16", "fanout64"
+  };
+  enum { NUM_CONFIGS = sizeof(configs) / sizeof(configs[0]) };
+
+  printf("%u publishes per test, ns per publish\n",
+         static_cast<unsigned>(NUM_ROUNDS * BATCH_LENGTH));
+  printf("%11s %10s %10s %14s\n",
+         "subscribers", "unsafe", "locking", "unsafe/sub");
+
+  bool ok = true;
+  for (size_t c = 0; c < NUM_CONFIGS; ++c) {
+    const size_t num_subs = configs[c];
+    static r2p::Node *nodes[NUM_CONFIGS][NODES_PER_CONFIG];
+    static BenchSubscriber subs[NUM_CONFIGS][MAX_SUBSCRIBERS];
+    static r2p::Publisher<BenchMsg> pubs[NUM_CONFIGS];
+
+    for (size_t i = 0; i < num_subs; ++i) {
+      r2p::Node *&nodep = nodes[c][i / r2p::Node::MAX_SUBSCRIBERS];
+      if (nodep == NULL) {
+        nodep = new r2p::Node("bench");
+      }
+      if (!nodep->subscribe(subs[c][i], topic_names[c])) _exit(EXIT_FAILURE);
+    }
+    if (!nodes[c][0]->advertise(pubs[c], topic_names[c])) _exit(EXIT_FAILURE);
+
+    const double unsafe_ns = run(pubs[c], subs[c], num_subs, true);
+    const double locking_ns = run(pubs[c], subs[c], num_subs, false);
+    if (unsafe_ns < 0 || locking_ns < 0) {
+      ok = false;
+      continue;
+    }
+    printf("%11u %10.1f %10.1f %14.1f\n", static_cast<unsigned>(num_subs),
+           unsafe_ns, locking_ns, unsafe_ns / num_subs);
+  }
+  if (!ok) {
+    printf("FAILED: messages lost\n");
+  }
+  fflush(stdout);
+
+  // The middleware threads never end, leave without destroying them
+  _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,177 @@
+// Contention benchmark of the subscriber queue flavors: 1 to 8 publishing
+// threads post into one queue, drained by a single consumer thread.
+
+#include <r2p/common.hpp>
+#include <r2p/ArrayQueue.hpp>
+#include <r2p/SpscQueue.hpp>
+#include <r2p/MpscQueue.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+using namespace r2p;
+
+enum { QUEUE_LENGTH = 64 };
+enum { MAX_PRODUCERS = 8 };
+enum { NUM_ITEMS = 1 << 21 };
+
+
+struct Item {
+  uint32_t producer;
+  uint32_t value;
+  volatile size_t seq;
+
+  Item &operator = (const Item &other) {
+    producer = other.producer;
+    value = other.value;
+    return *this;
+  }
+
+  Item() : producer(), value() {}
+  Item(const Item &other) : producer(other.producer), value(other.value) {}
+};
+
+
+// Same call shapes for all the queues, as used by the subscribers
+struct ArrayQueueTraits {
+  typedef ArrayQueue<Item> Queue;
+  static const char *name() { return "ArrayQueue"; }
+  static bool post(Queue &q, const Item &item) { return q.post(item); }
+  static bool fetch(Queue &q, Item &item) { return q.fetch(item); }
+};
+
+
+struct SpscQueueTraits {
+  typedef SpscQueue<Item> Queue;
+  static const char *name() { return "SpscQueue"; }
+  static bool post(Queue &q, const Item &item) {
+    // Producers serialized by SysLock, as in the notify paths
+    SysLock::acquire();
+    bool success = q.post_unsafe(item);
+    SysLock::release();
+    return success;
+  }
+  static bool fetch(Queue &q, Item &item) { return q.fetch(item); }
+};
+
+
+struct MpscQueueTraits {
+  typedef MpscQueue<Item> Queue;
+  static const char *name() { return "MpscQueue"; }
+  static bool post(Queue &q, const Item &item) { return q.post(item); }
+  static bool fetch(Queue &q, Item &item) { return q.fetch(item); }
+};
+
+
+template<typename Traits>
+struct Bench {
+  Item buf[QUEUE_LENGTH];
+  typename Traits::Queue queue;
+  size_t num_producers;
+  volatile bool go;
+  bool ok;
+
+  struct Producer {
+    Bench *benchp;
+    uint32_t id;
+  };
+
+  static void *producer_threadf(void *argp) {
+    Producer &p = *reinterpret_cast<Producer *>(argp);
+    Bench &b = *p.benchp;
+    const uint32_t count = NUM_ITEMS / b.num_producers;
+    while (!b.go) sched_yield();
+    Item item;
+    item.producer = p.id;
+    for (uint32_t i = 0; i < count; ++i) {
+      item.value = i;
+      while (!Traits::post(b.queue, item)) sched_yield();
+    }
+    return NULL;
+  }
+
+  void consume() {
+    uint32_t next[MAX_PRODUCERS] = { 0 };
+    const size_t total = (NUM_ITEMS / num_producers) * num_producers;
+    Item item;
+    for (size_t n = 0; n < total; ++n) {
+      while (!Traits::fetch(queue, item)) sched_yield();
+      if (item.producer >= num_producers || item.value != next[item.producer]) {
+        ok = false; // Lost, duplicated or reordered
+      }
+      ++next[item.producer];
+    }
+  }
+
+  double run() {
+    pthread_t threads[MAX_PRODUCERS];
+    Producer producers[MAX_PRODUCERS];
+    go = false;
+    for (size_t i = 0; i < num_producers; ++i) {
+      producers[i].benchp = this;
+      producers[i].id = static_cast<uint32_t>(i);
+      pthread_create(&threads[i], NULL, producer_threadf, &producers[i]);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    go = true;
+    consume();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (size_t i = 0; i < num_producers; ++i) {
+      pthread_join(threads[i], NULL);
+    }
+    const double seconds = (end.tv_sec - start.tv_sec) +
+                           (end.tv_nsec - start.tv_nsec) / 1e9;
+    return (NUM_ITEMS / num_producers) * num_producers / seconds / 1e6;
+  }
+
+  Bench(size_t num_producers)
+  :
+    queue(buf, QUEUE_LENGTH),
+    num_producers(num_producers),
+    go(false),
+    ok(true)
+  {}
+};
+
+
+template<typename Traits>
+bool bench_row() {
+
+  bool ok = true;
+  printf("%-12s", Traits::name());
+  for (size_t n = 1; n <= MAX_PRODUCERS; ++n) {
+    Bench<Traits> *benchp = new Bench<Traits>(n);
+    printf(" %7.2f", benchp->run());
+    fflush(stdout);
+    ok = ok && benchp->ok;
+    delete benchp;
+  }
+  printf("\n");
+  return ok;
+}
+
+
+int main() {
+
+  printf("Mmsg/s with 1..%d publishing threads, queue length %d\n",
+         MAX_PRODUCERS, QUEUE_LENGTH);
+  printf("%-12s", "producers");
+  for (int n = 1; n <= MAX_PRODUCERS; ++n) printf(" %7d", n);
+  printf("\n");
+
+  bool ok = true;
+  ok = bench_row<ArrayQueueTraits>() && ok;
+  ok = bench_row<SpscQueueTraits>() && ok;
+  ok = bench_row<MpscQueueTraits>() && ok;
+  if (!ok) {
+    printf("FAILED: lost, duplicated or reordered messages\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
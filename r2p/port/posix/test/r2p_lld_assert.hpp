@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cassert>
+
+#if !defined(R2P_ASSERT) || defined(__DOXYGEN__)
+#define R2P_ASSERT(expr)    { assert(expr); }
+#endif
@@ -0,0 +1,256 @@
+// ShmTransport against UdpTransport between two processes of this host:
+// round trip time of a ping answered by the peer, then the rate of a one-way
+// flood. Each transport runs in its own pair of processes, the peer echoing
+// the pings and counting the flood.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/Publisher.hpp>
+#include <r2p/Subscriber.hpp>
+#include <r2p/transport/UdpTransport.hpp>
+#include <r2p/transport/ShmTransport.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+struct BenchMsg : public r2p::Message {
+  uint64_t value;
+  uint8_t  data[56];
+} R2P_PACKED;
+
+enum { NUM_PINGS = 1000 };
+enum { NUM_FLOOD = 1 << 14 };
+enum { QUEUE_LENGTH = 16 };
+enum { STACKLEN = 1024 };
+
+// Asks the peer for the number of flood messages it got
+static const uint64_t FLOOD_QUERY = ~static_cast<uint64_t>(0);
+
+static const char *const GROUP_ADDR = "239.255.82.51";
+static const uint16_t GROUP_PORT = 24010;
+static const char *const SHM_NAME = "/r2p_shm_bench";
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("HOST", "BOOT_HOST"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t mgmt_stack[STACKLEN];
+static uint8_t rx_stack[STACKLEN];
+static uint8_t tx_stack[STACKLEN];
+
+// Node, subscribers and publishers outlive the transport threads
+static r2p::Node *nodep;
+static r2p::Publisher<BenchMsg> ping_pub, pong_pub, flood_pub;
+static volatile uint64_t last_pong = 0;
+static uint64_t num_flood = 0;
+
+
+static uint64_t now_ns() {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+}
+
+
+static void send(r2p::Publisher<BenchMsg> &pub, uint64_t value) {
+
+  BenchMsg *msgp;
+  while (!pub.alloc(msgp)) {
+    r2p::Thread::yield();
+  }
+  msgp->value = value;
+  pub.publish(*msgp);
+}
+
+
+static bool ping_cb(const BenchMsg &msg) {
+
+  send(pong_pub, (msg.value == FLOOD_QUERY) ? num_flood : msg.value);
+  return true;
+}
+
+
+static bool pong_cb(const BenchMsg &msg) {
+
+  last_pong = msg.value;
+  return true;
+}
+
+
+static bool flood_cb(const BenchMsg &msg) {
+
+  (void)msg;
+  ++num_flood;
+  return true;
+}
+
+
+static bool start(const char *kindp, bool side_a) {
+
+  r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                       r2p::Thread::LOWEST);
+
+  bool success = false;
+  if (strcmp(kindp, "udp") == 0) {
+    static r2p::UdpTransport udptra("UDP", GROUP_ADDR, GROUP_PORT,
+                                    side_a ? 24011 : 24012);
+    success = udptra.initialize(rx_stack, sizeof(rx_stack),
+                                r2p::Thread::NORMAL,
+                                tx_stack, sizeof(tx_stack),
+                                r2p::Thread::NORMAL);
+  } else {
+    static r2p::ShmTransport shmtra("SHM", SHM_NAME,
+                                    side_a ? r2p::ShmTransport::SIDE_A
+                                           : r2p::ShmTransport::SIDE_B);
+    success = shmtra.initialize(rx_stack, sizeof(rx_stack),
+                                r2p::Thread::NORMAL,
+                                tx_stack, sizeof(tx_stack),
+                                r2p::Thread::NORMAL);
+  }
+  if (!success) return false;
+
+  r2p::Middleware::instance.start();
+  return true;
+}
+
+
+// Spins until the pong carrying the value arrives
+static bool wait_pong(uint64_t value, const r2p::Time &timeout) {
+
+  const r2p::Time deadline = r2p::Time::now() + timeout;
+  while (last_pong != value) {
+    if (r2p::Time::now() >= deadline) return false;
+    nodep->spin(r2p::Time::ms(10));
+  }
+  return true;
+}
+
+
+static int run_echo(const char *kindp) {
+
+  if (!start(kindp, false)) return 2;
+
+  static r2p::Subscriber<BenchMsg, QUEUE_LENGTH> ping_sub(ping_cb);
+  static r2p::Subscriber<BenchMsg, QUEUE_LENGTH> flood_sub(flood_cb);
+  nodep = new r2p::Node("echo");
+  nodep->advertise(pong_pub, "pong");
+  nodep->subscribe(ping_sub, "ping");
+  nodep->subscribe(flood_sub, "flood");
+  for (;;) {
+    nodep->spin(r2p::Time::ms(100));
+  }
+  return 0;
+}
+
+
+static int run_measure(const char *kindp) {
+
+  if (!start(kindp, true)) return 2;
+
+  static r2p::Subscriber<BenchMsg, QUEUE_LENGTH> pong_sub(pong_cb);
+  nodep = new r2p::Node("measure");
+  nodep->advertise(ping_pub, "ping");
+  nodep->advertise(flood_pub, "flood");
+  nodep->subscribe(pong_sub, "pong");
+
+  // Ping until the peer has subscribed and answers
+  bool linked = false;
+  for (unsigned i = 0; i < 100 && !linked; ++i) {
+    send(ping_pub, 1);
+    linked = wait_pong(1, r2p::Time::ms(100));
+  }
+  if (!linked) return 1;
+  r2p::Thread::sleep(r2p::Time::ms(200));
+
+  uint64_t start = now_ns();
+  for (uint64_t i = 2; i < NUM_PINGS + 2; ++i) {
+    send(ping_pub, i);
+    if (!wait_pong(i, r2p::Time::s(1))) return 1;
+  }
+  const double rtt_us = (now_ns() - start) / 1e3 / NUM_PINGS;
+
+  // The pool of the flood topic throttles the publisher to the TX thread,
+  // losses happen on the receiving side only
+  start = now_ns();
+  for (unsigned i = 0; i < NUM_FLOOD; ++i) {
+    send(flood_pub, i);
+  }
+  r2p::Thread::sleep(r2p::Time::ms(10));
+  last_pong = 0;
+  bool answered = false;
+  uint64_t received = 0;
+  for (unsigned i = 0; i < 100 && !answered; ++i) {
+    send(ping_pub, FLOOD_QUERY);
+    const r2p::Time deadline = r2p::Time::now() + r2p::Time::ms(100);
+    while (last_pong == 0 && r2p::Time::now() < deadline) {
+      nodep->spin(r2p::Time::ms(10));
+    }
+    received = last_pong;
+    answered = received > 0;
+  }
+  const double seconds = (now_ns() - start) / 1e9;
+  if (!answered) return 1;
+
+  printf("%-4s %10.1f %12.1f %9u/%u\n", kindp, rtt_us,
+         received / seconds / 1e3, static_cast<unsigned>(received),
+         static_cast<unsigned>(NUM_FLOOD));
+  return 0;
+}
+
+
+static bool run(const char *kindp) {
+
+  pid_t runner = fork();
+  if (runner < 0) return false;
+  if (runner == 0) {
+    pid_t echo = fork();
+    if (echo < 0) _exit(2);
+    if (echo == 0) {
+      // The middleware threads never end, leave without destroying them
+      _exit(run_echo(kindp));
+    }
+    int rc = run_measure(kindp);
+    fflush(stdout);
+    kill(echo, SIGKILL);
+    waitpid(echo, NULL, 0);
+    shm_unlink(SHM_NAME);
+    _exit(rc);
+  }
+  int status;
+  return waitpid(runner, &status, 0) == runner && WIFEXITED(status) &&
+         WEXITSTATUS(status) == 0;
+}
+
+
+int main() {
+
+  printf("%u-byte messages, %u pings, %u flood messages\n",
+         static_cast<unsigned>(sizeof(BenchMsg) - sizeof(r2p::Message)),
+         static_cast<unsigned>(NUM_PINGS), static_cast<unsigned>(NUM_FLOOD));
+  printf("%-4s %10s %12s %15s\n", "link", "rtt us", "flood kmsg/s",
+         "received");
+  fflush(stdout);
+
+  bool ok = run("udp");
+  ok = run("shm") && ok;
+  if (!ok) {
+    printf("FAILED: no answer from the peer\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
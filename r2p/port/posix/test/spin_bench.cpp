@@ -0,0 +1,170 @@
+// Lock acquisitions per message when a node drains a burst of messages.
+// The per-message path fetches and releases each message on its own, as
+// Node::spin() used to; Node::spin() now fetches a batch under one lock and
+// releases it under another.
+// pthread_mutex_lock() is wrapped at link time to count the acquisitions
+// of the spinning thread, SysLock included.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/Publisher.hpp>
+#include <r2p/Subscriber.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+struct BenchMsg : public r2p::Message {
+  uint64_t value;
+} R2P_PACKED;
+
+enum { QUEUE_LENGTH = 16 };
+enum { BURST_LENGTH = 8 };
+enum { NUM_ROUNDS = 1 << 14 };
+enum { STACKLEN = 1024 };
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("BENCH", "BOOT_BENCH"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t mgmt_stack[STACKLEN];
+
+static __thread unsigned long num_locks = 0;
+static unsigned long num_received = 0;
+
+
+extern "C" int __real_pthread_mutex_lock(pthread_mutex_t *mutexp);
+
+extern "C" int __wrap_pthread_mutex_lock(pthread_mutex_t *mutexp) {
+
+  ++num_locks;
+  return __real_pthread_mutex_lock(mutexp);
+}
+
+
+static uint64_t now_ns() {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+}
+
+
+static bool bench_cb(const BenchMsg &msg) {
+
+  (void)msg;
+  ++num_received;
+  return true;
+}
+
+
+struct Result {
+  unsigned long locks;
+  uint64_t elapsed;
+};
+
+
+static bool publish_burst(r2p::Publisher<BenchMsg> &pub) {
+
+  for (unsigned i = 0; i < BURST_LENGTH; ++i) {
+    BenchMsg *msgp;
+    if (!pub.alloc(msgp)) return false;
+    msgp->value = i;
+    pub.publish(*msgp);
+  }
+  return true;
+}
+
+
+static bool run_per_message(r2p::Publisher<BenchMsg> &pub,
+                            r2p::Subscriber<BenchMsg, QUEUE_LENGTH> &sub,
+                            Result &result) {
+
+  result.locks = 0;
+  result.elapsed = 0;
+  for (unsigned round = 0; round < NUM_ROUNDS; ++round) {
+    if (!publish_burst(pub)) return false;
+
+    const unsigned long locks = num_locks;
+    const uint64_t start = now_ns();
+    BenchMsg *msgp;
+    while (sub.fetch(msgp)) {
+      bench_cb(*msgp);
+      sub.release(*msgp);
+    }
+    result.elapsed += now_ns() - start;
+    result.locks += num_locks - locks;
+  }
+  return true;
+}
+
+
+static bool run_spin(r2p::Publisher<BenchMsg> &pub, r2p::Node &node,
+                     Result &result) {
+
+  result.locks = 0;
+  result.elapsed = 0;
+  for (unsigned round = 0; round < NUM_ROUNDS; ++round) {
+    if (!publish_burst(pub)) return false;
+
+    const unsigned long locks = num_locks;
+    const uint64_t start = now_ns();
+    if (!node.spin(r2p::Time::IMMEDIATE)) return false;
+    result.elapsed += now_ns() - start;
+    result.locks += num_locks - locks;
+  }
+  return true;
+}
+
+
+static void print(const char *namep, const Result &result) {
+
+  const double num_msgs = static_cast<double>(NUM_ROUNDS) * BURST_LENGTH;
+  printf("%-12s %10.2f %10.1f\n", namep, result.locks / num_msgs,
+         result.elapsed / num_msgs);
+}
+
+
+int main() {
+
+  r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                       r2p::Thread::LOWEST);
+  r2p::Middleware::instance.start();
+
+  r2p::Node node("spin");
+  r2p::Subscriber<BenchMsg, QUEUE_LENGTH> sub(bench_cb);
+  r2p::Publisher<BenchMsg> pub;
+  if (!node.subscribe(sub, "spin") || !node.advertise(pub, "spin")) {
+    _exit(EXIT_FAILURE);
+  }
+
+  printf("bursts of %u messages, batches of %u\n",
+         static_cast<unsigned>(BURST_LENGTH),
+         static_cast<unsigned>(R2P_NODE_SPIN_BATCH_LENGTH));
+  printf("%-12s %10s %10s\n", "path", "locks/msg", "ns/msg");
+
+  // Clear the events of the per-message runs before spinning
+  Result per_message = { 0, 0 };
+  Result batched = { 0, 0 };
+  bool ok = run_per_message(pub, sub, per_message);
+  ok = ok && node.spin(r2p::Time::IMMEDIATE) && run_spin(pub, node, batched);
+  ok = ok && num_received == 2ul * NUM_ROUNDS * BURST_LENGTH;
+  print("per-message", per_message);
+  print("Node::spin", batched);
+
+  if (!ok) {
+    printf("FAILED: messages lost\n");
+  }
+  fflush(stdout);
+  _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,177 @@
+// Two-level SpinEvent masks, built with R2P_SPINEVENT_NUM_GROUPS=4: the
+// group summary and masks of a bare SpinEvent, then a node with more
+// subscribers than a mask has bits, signaled in every group.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/Publisher.hpp>
+#include <r2p/Subscriber.hpp>
+#include <r2p/SpinEvent.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+struct IndexMsg : public r2p::Message {
+  uint64_t index;
+} R2P_PACKED;
+
+enum { NUM_SUBSCRIBERS = 100 };
+enum { QUEUE_LENGTH = 2 };
+enum { NAME_LENGTH = 8 };
+enum { STACKLEN = 1024 };
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("TEST", "BOOT_TEST"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static uint8_t mgmt_stack[STACKLEN];
+static unsigned received[NUM_SUBSCRIBERS];
+
+
+static bool index_cb(const IndexMsg &msg) {
+
+  ++received[msg.index];
+  return true;
+}
+
+
+class IndexSubscriber : public r2p::Subscriber<IndexMsg, QUEUE_LENGTH> {
+public:
+  IndexSubscriber() : r2p::Subscriber<IndexMsg, QUEUE_LENGTH>(index_cb) {}
+};
+
+
+static bool check(bool condition, const char *whatp) {
+
+  if (!condition) {
+    printf("FAILED: %s\n", whatp);
+  }
+  return condition;
+}
+
+
+static bool test_masks() {
+
+  typedef r2p::SpinEvent::Mask Mask;
+  const unsigned width = r2p::SpinEvent::MASK_WIDTH;
+  r2p::SpinEvent event;
+  Mask masks[r2p::SpinEvent::NUM_GROUPS];
+
+  event.signal(5);
+  event.signal(width + 5);
+  event.signal(width + 7);
+  event.signal(r2p::SpinEvent::MAX_INDEX);
+  Mask summary = event.wait(r2p::Time::IMMEDIATE, masks);
+  bool ok = check(summary == ((1u << 0) | (1u << 1) | (1u << 3)),
+                  "group summary");
+  ok = check(masks[0] == (static_cast<Mask>(1) << 5), "mask of group 0") &&
+       ok;
+  ok = check(masks[1] == ((static_cast<Mask>(1) << 5) |
+                          (static_cast<Mask>(1) << 7)), "mask of group 1") &&
+       ok;
+  ok = check(masks[3] == (static_cast<Mask>(1) << (width - 1)),
+             "mask of group 3") && ok;
+
+  // The masks are consumed by the wait
+  summary = event.wait(r2p::Time::IMMEDIATE, masks);
+  ok = check(summary == 0, "masks cleared after the wait") && ok;
+  return ok;
+}
+
+
+static bool expect(const bool expected[], const char *whatp) {
+
+  bool ok = true;
+  for (unsigned i = 0; i < NUM_SUBSCRIBERS; ++i) {
+    if (received[i] != (expected[i] ? 1u : 0u)) {
+      printf("subscriber %u: %u messages\n", i, received[i]);
+      ok = false;
+    }
+    received[i] = 0;
+  }
+  return check(ok, whatp);
+}
+
+
+static bool test_node() {
+
+  static char names[NUM_SUBSCRIBERS][NAME_LENGTH];
+  static IndexSubscriber subs[NUM_SUBSCRIBERS];
+  static r2p::Publisher<IndexMsg> pubs[NUM_SUBSCRIBERS];
+
+  r2p::Node &node = *new r2p::Node("test");
+  for (unsigned i = 0; i < NUM_SUBSCRIBERS; ++i) {
+    snprintf(names[i], NAME_LENGTH, "idx%03u", i);
+    if (!node.subscribe(subs[i], names[i]) ||
+        !node.advertise(pubs[i], names[i])) {
+      return check(false, "subscribe");
+    }
+  }
+
+  // First and last bit of each group, and a subscriber past the first mask
+  const unsigned width = r2p::SpinEvent::MASK_WIDTH;
+  static const unsigned picks[] = {
+    0, width - 1, width, 2 * width - 1, 2 * width, 3 * width,
+    NUM_SUBSCRIBERS - 1
+  };
+  bool expected[NUM_SUBSCRIBERS] = { false };
+  for (unsigned k = 0; k < sizeof(picks) / sizeof(picks[0]); ++k) {
+    IndexMsg *msgp;
+    if (!pubs[picks[k]].alloc(msgp)) return check(false, "alloc");
+    msgp->index = picks[k];
+    pubs[picks[k]].publish(*msgp);
+    expected[picks[k]] = true;
+  }
+  while (node.spin(r2p::Time::IMMEDIATE)) {}
+  bool ok = expect(expected, "picked subscribers dispatched");
+
+  for (unsigned i = 0; i < NUM_SUBSCRIBERS; ++i) {
+    IndexMsg *msgp;
+    if (!pubs[i].alloc(msgp)) return check(false, "alloc");
+    msgp->index = i;
+    pubs[i].publish(*msgp);
+    expected[i] = true;
+  }
+  while (node.spin(r2p::Time::IMMEDIATE)) {}
+  ok = expect(expected, "all subscribers dispatched") && ok;
+
+  // A stop wakes the node without dispatching anything
+  node.notify_stop();
+  ok = check(node.spin(r2p::Time::IMMEDIATE), "stop event") && ok;
+  for (unsigned i = 0; i < NUM_SUBSCRIBERS; ++i) {
+    expected[i] = false;
+  }
+  ok = expect(expected, "nothing dispatched on stop") && ok;
+  return ok;
+}
+
+
+int main() {
+
+  r2p::Middleware::instance.initialize(mgmt_stack, sizeof(mgmt_stack),
+                                       r2p::Thread::LOWEST);
+  r2p::Middleware::instance.start();
+
+  printf("%u groups of %u events, %u subscribers\n",
+         static_cast<unsigned>(r2p::SpinEvent::NUM_GROUPS),
+         static_cast<unsigned>(r2p::SpinEvent::MASK_WIDTH),
+         static_cast<unsigned>(NUM_SUBSCRIBERS));
+  bool ok = test_masks();
+  ok = test_node() && ok;
+  if (ok) {
+    printf("OK\n");
+  }
+  fflush(stdout);
+
+  // The middleware threads never end, leave without destroying them
+  _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,46 @@
+// Time algebra around the infinities. Exits with 0 on success.
+
+#include <r2p/Time.hpp>
+
+#include <cstdio>
+
+using r2p::Time;
+
+#define CHECK(expr) \
+  do { if (!(expr)) { printf("FAILED: %s\n", #expr); ++failures; } } while (0)
+
+
+int main() {
+
+  int failures = 0;
+  const Time inf(Time::MAX_US + 1);
+  const Time ninf(Time::MIN_US - 1);
+
+  CHECK(inf == Time::INFINITE);
+  CHECK(ninf == Time::INFINITEN);
+
+  // Deadlines from infinite timeouts stay infinite
+  CHECK(Time::us(5) + inf == inf);
+  CHECK(inf + Time::us(-5) == inf);
+  CHECK(inf - Time::us(5) == inf);
+  CHECK(ninf + Time::us(5) == ninf);
+  CHECK(Time::us(5) - inf == ninf);
+  CHECK(Time::us(5) - ninf == inf);
+
+  // Finite values saturate instead of wrapping
+  CHECK(Time::us(Time::MAX_US) + Time::us(1) == inf);
+  CHECK(Time::us(Time::MIN_US) - Time::us(1) == ninf);
+  CHECK(Time::us(Time::MAX_US) - Time::us(Time::MIN_US) == inf);
+  CHECK(Time::us(7) - Time::us(9) == Time::us(-2));
+
+  Time t = Time::us(10);
+  t -= Time::us(3);
+  CHECK(t == Time::us(7));
+  t += Time::us(3);
+  CHECK(t == Time::us(10));
+  t += inf;
+  CHECK(t == inf);
+
+  printf("time: %s\n", (failures == 0) ? "ok" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
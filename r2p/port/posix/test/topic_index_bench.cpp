@@ -0,0 +1,103 @@
+// Topic lookup time at 10, 100 and 1000 topics: the TopicIndex hash table
+// used by Middleware::find_topic(), against the walk of the topic list with
+// Topic::has_name() that it replaces.
+
+#include <r2p/common.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/Topic.hpp>
+#include <r2p/TopicIndex.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+#include <unistd.h>
+
+enum { MAX_TOPICS = 1000 };
+enum { NUM_LOOKUPS = 1 << 18 };
+enum { NAME_LENGTH = 8 };
+
+#if R2P_USE_BRIDGE_MODE
+enum { PUBSUB_BUFFER_LENGTH = 16 };
+static r2p::Middleware::PubSubStep pubsub_buf[PUBSUB_BUFFER_LENGTH];
+#endif
+
+r2p::Middleware r2p::Middleware::instance("BENCH", "BOOT_BENCH"
+#if R2P_USE_BRIDGE_MODE
+  , pubsub_buf, PUBSUB_BUFFER_LENGTH
+#endif
+);
+
+static char names[MAX_TOPICS][NAME_LENGTH];
+static r2p::Topic *topics[MAX_TOPICS];
+// Half full at most, as sized by the firmware mains
+static r2p::Topic *index_buf[2 * MAX_TOPICS];
+
+
+static uint64_t now_ns() {
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + ts.tv_nsec;
+}
+
+
+static r2p::Topic *walk(size_t num_topics, const char *namep) {
+
+  for (size_t i = 0; i < num_topics; ++i) {
+    if (r2p::Topic::has_name(*topics[i], namep)) return topics[i];
+  }
+  return NULL;
+}
+
+
+// Returns the average lookup time in ns, or a negative value on a mismatch
+template<bool INDEXED>
+static double run(const r2p::TopicIndex &index, size_t num_topics) {
+
+  size_t k = 0;
+  const uint64_t start = now_ns();
+  for (unsigned i = 0; i < NUM_LOOKUPS; ++i) {
+    // Stride through the names, so that they are not visited in order
+    k += 7919;
+    if (k >= num_topics) k %= num_topics;
+    r2p::Topic *topicp = INDEXED ? index.find(names[k])
+                                 : walk(num_topics, names[k]);
+    if (topicp != topics[k]) return -1;
+  }
+  return static_cast<double>(now_ns() - start) / NUM_LOOKUPS;
+}
+
+
+int main() {
+
+  for (size_t i = 0; i < MAX_TOPICS; ++i) {
+    snprintf(names[i], NAME_LENGTH, "tpc%04u", static_cast<unsigned>(i));
+    topics[i] = new r2p::Topic(names[i], sizeof(r2p::Message));
+  }
+
+  printf("%u lookups per test, ns per lookup\n",
+         static_cast<unsigned>(NUM_LOOKUPS));
+  printf("%7s %10s %10s\n", "topics", "index", "list");
+
+  bool ok = true;
+  static const size_t configs[] = { 10, 100, MAX_TOPICS };
+  for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); ++c) {
+    const size_t num_topics = configs[c];
+    r2p::TopicIndex index(index_buf, 2 * num_topics);
+    for (size_t i = 0; i < num_topics; ++i) {
+      ok = index.insert(*topics[i]) && ok;
+    }
+
+    const double indexed_ns = run<true>(index, num_topics);
+    const double walked_ns = run<false>(index, num_topics);
+    ok = ok && indexed_ns >= 0 && walked_ns >= 0;
+    printf("%7u %10.1f %10.1f\n", static_cast<unsigned>(num_topics),
+           indexed_ns, walked_ns);
+  }
+
+  if (!ok) {
+    printf("FAILED: wrong topic found\n");
+  }
+  fflush(stdout);
+  _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
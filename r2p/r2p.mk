@@ -8,9 +8,12 @@ R2PSRC = $(R2P)/src/impl/ArrayQueue_.cpp \
          $(R2P)/src/BaseSubscriberQueue.cpp \
 		 $(R2P)/src/BootMsg.cpp \
 		 $(R2P)/src/Checksummer.cpp \
+         $(R2P)/src/Crc.cpp \
+         $(R2P)/src/Executor.cpp \
          $(R2P)/src/LocalPublisher.cpp \
          $(R2P)/src/LocalSubscriber.cpp \
          $(R2P)/src/MessagePtrQueue.cpp \
+         $(R2P)/src/MessageSlab.cpp \
 		 $(R2P)/src/Message.cpp \
          $(R2P)/src/Middleware.cpp \
          $(R2P)/src/Node.cpp \
@@ -19,6 +22,7 @@ R2PSRC = $(R2P)/src/impl/ArrayQueue_.cpp \
          $(R2P)/src/Time.cpp \
          $(R2P)/src/TimestampedMsgPtrQueue.cpp \
          $(R2P)/src/Topic.cpp \
+         $(R2P)/src/TopicIndex.cpp \
          $(R2P)/src/Transport.cpp \
          $(R2P)/src/Utils.cpp \
 #
@@ -40,6 +44,16 @@ R2PSRC += $(R2P)/src/transport/RTCANTransport.cpp \
           $(R2P)/src/transport/RTCANPublisher.cpp \
           $(R2P)/src/transport/RTCANSubscriber.cpp
 endif
+ifeq ($(R2P_USE_UDPTRANSPORT),yes)
+R2PSRC += $(R2P)/src/transport/UdpTransport.cpp \
+          $(R2P)/src/transport/UdpPublisher.cpp \
+          $(R2P)/src/transport/UdpSubscriber.cpp
+endif
+ifeq ($(R2P_USE_SHMTRANSPORT),yes)
+R2PSRC += $(R2P)/src/transport/ShmTransport.cpp \
+          $(R2P)/src/transport/ShmPublisher.cpp \
+          $(R2P)/src/transport/ShmSubscriber.cpp
+endif
 
 R2PINC = $(R2P)/include \
 #
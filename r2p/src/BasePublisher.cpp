@@ -10,6 +10,9 @@ bool BasePublisher::publish_unsafe(Message &msg) {
 
   R2P_ASSERT(topicp != NULL);
 
+#if R2P_USE_TRAFFIC_COUNTERS
+  topicp->count_publish_unsafe();
+#endif
   msg.acquire_unsafe();
 
   Time now = Time::now();
@@ -29,6 +32,9 @@ bool BasePublisher::publish_locally_unsafe(Message &msg) {
 
   R2P_ASSERT(topicp != NULL);
 
+#if R2P_USE_TRAFFIC_COUNTERS
+  topicp->count_publish_unsafe();
+#endif
   msg.acquire_unsafe();
   bool success = topicp->notify_locals_unsafe(msg, Time::now());
   if (!msg.release_unsafe()) {
@@ -42,6 +48,13 @@ bool BasePublisher::publish_remotely_unsafe(Message &msg) {
 
   R2P_ASSERT(topicp != NULL);
 
+#if R2P_USE_TRAFFIC_COUNTERS
+#if R2P_USE_BRIDGE_MODE
+  // Forwarded messages were already counted when published locally
+  if (msg.get_source() == NULL)
+#endif
+  topicp->count_publish_unsafe();
+#endif
   msg.acquire_unsafe();
   bool success = topicp->notify_remotes_unsafe(msg, Time::now());
   if (!msg.release_unsafe()) {
@@ -55,6 +68,10 @@ bool BasePublisher::publish(Message &msg) {
 
   R2P_ASSERT(topicp != NULL);
 
+#if R2P_USE_TRAFFIC_COUNTERS
+  { SysLock::Scope lock;
+  topicp->count_publish_unsafe(); }
+#endif
   msg.acquire();
 
   Time now = Time::now();
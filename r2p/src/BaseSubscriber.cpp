@@ -18,15 +18,36 @@ bool BaseSubscriber::release_unsafe(Message &msg) {
 }
 
 
-bool BaseSubscriber::release(Message &msg) {
+void BaseSubscriber::release_n_unsafe(TimestampedMsgPtrQueue::Entry entries[],
+                                      size_t count) {
 
   R2P_ASSERT(topicp != NULL);
 
-  if (!msg.release()) {
-    topicp->free(msg);
-    return false;
+  while (count-- > 0) {
+    Message &msg = *(entries++)->msgp;
+    if (!msg.release_unsafe()) {
+      topicp->free_unsafe(msg);
+    }
   }
-  return true;
+}
+
+
+bool BaseSubscriber::release(Message &msg) {
+
+  // The last reference is dropped and freed under the same lock
+  SysLock::acquire();
+  bool referenced = release_unsafe(msg);
+  SysLock::release();
+  return referenced;
+}
+
+
+void BaseSubscriber::release_n(TimestampedMsgPtrQueue::Entry entries[],
+                               size_t count) {
+
+  SysLock::acquire();
+  release_n_unsafe(entries, count);
+  SysLock::release();
 }
 
 
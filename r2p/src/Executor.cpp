@@ -0,0 +1,254 @@
+#include <r2p/Executor.hpp>
+#include <r2p/Node.hpp>
+#include <r2p/SysLock.hpp>
+
+namespace r2p {
+
+
+void Executor::add(Node &node) {
+
+  SysLock::acquire();
+  R2P_ASSERT(node.executorp == NULL);
+
+  // Each node sits in at most one queue, so the queues can hold all of them
+  size_t capacity = 0;
+  for (size_t i = 0; i < num_workers; ++i) {
+    capacity += workerpp[i]->ready_queue.get_length();
+  }
+  R2P_ASSERT(num_nodes < capacity);
+  (void)capacity;
+
+  ++num_nodes;
+  node.event.set_thread(NULL);
+  node.executorp = this;
+  node.exec_state = Node::QUEUED; // Drain anything already pending
+  node.exec_worker = static_cast<uint_least8_t>(next_worker);
+  enqueue_unsafe(node, next_worker);
+  if (++next_worker >= num_workers) next_worker = 0;
+  SysLock::release();
+}
+
+
+bool Executor::start(size_t index, void *stackp, size_t stacklen,
+                     Thread::Priority priority) {
+
+  R2P_ASSERT(index < num_workers);
+  R2P_ASSERT(workerpp[index]->threadp == NULL);
+
+  workerpp[index]->threadp = Thread::create_static(
+    stackp, stacklen, priority, worker_threadf,
+    reinterpret_cast<void *>(workerpp[index]), "R2P_EXEC"
+  );
+  return workerpp[index]->threadp != NULL;
+}
+
+
+bool Executor::spin(const Time &timeout) {
+
+  Worker &worker = *workerpp[0];
+  R2P_ASSERT(worker.threadp == NULL || worker.threadp == &Thread::self());
+  worker.threadp = &Thread::self();
+
+  // Block once for any ready node, then serve whatever else is ready
+  if (!wait_ready(0, timeout)) return false;
+  while (run_next(0)) {}
+  return true;
+}
+
+
+void Executor::stop() {
+
+  SysLock::acquire();
+  stopped = true;
+  for (size_t i = 0; i < num_workers; ++i) {
+    wake_unsafe(i);
+  }
+  SysLock::release();
+}
+
+
+// Safe from any context: the caller names the preferred worker
+void Executor::schedule_unsafe(Node &node, size_t index) {
+
+  R2P_ASSERT(node.executorp == this);
+  R2P_ASSERT(index < num_workers);
+
+  switch (node.exec_state) {
+  case Node::IDLE: {
+    node.exec_state = Node::QUEUED;
+    enqueue_unsafe(node, index);
+    break;
+  }
+  case Node::RUNNING: {
+    node.exec_state = Node::RERUN;
+    break;
+  }
+  default: {
+    break; // Already queued or due to run again
+  }
+  }
+}
+
+
+void Executor::enqueue_unsafe(Node &node, size_t index) {
+
+  for (size_t i = 0; i < num_workers; ++i) {
+    if (workerpp[index]->ready_queue.post_unsafe(&node)) {
+      wake_unsafe(index);
+      return;
+    }
+    if (++index >= num_workers) index = 0;
+  }
+  R2P_ASSERT(false); // Ready queues full
+}
+
+
+// Wakes the owner of the queue, else any idle worker, which will steal
+void Executor::wake_unsafe(size_t index) {
+
+  if (!workerpp[index]->idle) {
+    for (size_t i = 0; i < num_workers; ++i) {
+      if (workerpp[i]->idle) {
+        index = i;
+        break;
+      }
+    }
+  }
+  Worker &worker = *workerpp[index];
+  if (worker.idle) {
+    worker.idle = false;
+    worker.wakeup_sem.signal_unsafe();
+  }
+}
+
+
+bool Executor::has_ready_unsafe() const {
+
+  for (size_t i = 0; i < num_workers; ++i) {
+    if (workerpp[i]->ready_queue.get_count() > 0) return true;
+  }
+  return false;
+}
+
+
+// Returns false on timeout or stop
+bool Executor::wait_ready(size_t index, const Time &timeout) {
+
+  Worker &worker = *workerpp[index];
+  bool ready = true;
+  SysLock::acquire();
+  if (!stopped && !has_ready_unsafe()) {
+    worker.idle = true;
+    if (timeout == Time::INFINITE) {
+      worker.wakeup_sem.wait_unsafe();
+    } else {
+      ready = worker.wakeup_sem.wait_unsafe(timeout);
+    }
+    worker.idle = false;
+  }
+  ready = ready && !stopped;
+  SysLock::release();
+  return ready;
+}
+
+
+Node *Executor::take_unsafe(size_t index) {
+
+  Node *nodep;
+  if (workerpp[index]->ready_queue.fetch_unsafe(nodep)) {
+    return nodep;
+  }
+
+  // Steal from the other workers, starting from the next one
+  for (size_t i = 1; i < num_workers; ++i) {
+    if (++index >= num_workers) index = 0;
+    if (workerpp[index]->ready_queue.fetch_unsafe(nodep)) {
+      return nodep;
+    }
+  }
+  return NULL;
+}
+
+
+bool Executor::run_next(size_t index) {
+
+  SysLock::acquire();
+  Node *nodep = stopped ? NULL : take_unsafe(index);
+  if (nodep != NULL) {
+    nodep->exec_state = Node::RUNNING;
+    nodep->exec_worker = static_cast<uint_least8_t>(index);
+  }
+  SysLock::release();
+  if (nodep == NULL) return false;
+
+  nodep->dispatch_all();
+
+  SysLock::acquire();
+  if (nodep->exec_state == Node::RERUN) {
+    // This worker takes it again next, no need to wake anyone
+    nodep->exec_state = Node::QUEUED;
+    if (!workerpp[index]->ready_queue.post_unsafe(nodep)) {
+      enqueue_unsafe(*nodep, index);
+    }
+  } else {
+    nodep->exec_state = Node::IDLE;
+  }
+  SysLock::release();
+  return true;
+}
+
+
+void Executor::do_worker(size_t index) {
+
+  // No polling: a worker sleeps only when every queue is empty, and stop()
+  // wakes them all
+  while (wait_ready(index, Time::INFINITE)) {
+    while (run_next(index)) {}
+  }
+}
+
+
+Executor::Executor(Worker *workers[], size_t num_workers)
+:
+  workerpp(workers),
+  num_workers(num_workers),
+  num_nodes(0),
+  next_worker(0),
+  stopped(false)
+{
+  R2P_ASSERT(workers != NULL);
+  R2P_ASSERT(num_workers > 0);
+  R2P_ASSERT(num_workers <= 255); // Node::exec_worker
+
+  for (size_t i = 0; i < num_workers; ++i) {
+    R2P_ASSERT(workers[i] != NULL);
+    R2P_ASSERT(workers[i]->executorp == NULL);
+    workers[i]->executorp = this;
+  }
+}
+
+
+Thread::Return Executor::worker_threadf(Thread::Argument arg) {
+
+  Worker *workerp = reinterpret_cast<Worker *>(arg);
+  Executor &executor = *workerp->executorp;
+  size_t index = 0;
+  while (executor.workerpp[index] != workerp) {
+    ++index;
+  }
+  executor.do_worker(index);
+  return Thread::OK;
+}
+
+
+Executor::Worker::Worker(Node *queue_buf[], size_t queue_length)
+:
+  executorp(NULL),
+  threadp(NULL),
+  ready_queue(queue_buf, queue_length),
+  wakeup_sem(0),
+  idle(false)
+{}
+
+
+} // namespace r2p
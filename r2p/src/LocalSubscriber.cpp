@@ -6,36 +6,48 @@ namespace r2p {
 
 bool LocalSubscriber::fetch(Message *&msgp) {
 
-  SysLock::acquire();
-  if (msgp_queue.fetch_unsafe(msgp)) {
-    SysLock::release();
-    return true;
-  } else {
-    SysLock::release();
-    return false;
-  }
+  Time timestamp;
+  return fetch(msgp, timestamp);
 }
 
 
 bool LocalSubscriber::fetch(Message *&msgp, Time &timestamp) {
 
-  SysLock::acquire();
-  if (msgp_queue.fetch_unsafe(msgp)) {
-    SysLock::release();
-    timestamp = Time::now();
+  TimestampedMsgPtrQueue::Entry entry;
+  if (tmsgp_queue.fetch(entry)) {
+    msgp = entry.msgp;
+    timestamp = entry.timestamp;
     return true;
-  } else {
-    SysLock::release();
-    return false;
   }
+  return false;
+}
+
+
+size_t LocalSubscriber::fetch_n(TimestampedMsgPtrQueue::Entry entries[],
+                                size_t max_count) {
+
+  return tmsgp_queue.fetch_n(entries, max_count);
 }
 
 
 bool LocalSubscriber::notify(Message &msg, const Time &timestamp) {
 
-  (void)timestamp;
+#if R2P_USE_MPSC_QUEUES
+  if (tmsgp_queue.get_kind() == TimestampedMsgPtrQueue::MPSC) {
+    // Concurrent publishers post without SysLock, only the wakeup needs it
+    TimestampedMsgPtrQueue::Entry entry(&msg, timestamp);
+    if (!tmsgp_queue.post(entry)) return false;
+    SysLock::acquire();
+#if R2P_USE_TRAFFIC_COUNTERS
+    counters.update_queue_depth(tmsgp_queue.get_count_unsafe());
+#endif
+    nodep->notify_unsafe(event_index);
+    SysLock::release();
+    return true;
+  }
+#endif
   SysLock::acquire();
-  if (msgp_queue.post_unsafe(&msg)) {
+  if (post_unsafe(msg, timestamp)) {
     nodep->notify_unsafe(event_index);
     SysLock::release();
     return true;
@@ -46,19 +58,26 @@ bool LocalSubscriber::notify(Message &msg, const Time &timestamp) {
 }
 
 
-LocalSubscriber::LocalSubscriber(Message *queue_buf[], size_t queue_length,
-                                 Callback callback)
+LocalSubscriber::LocalSubscriber(TimestampedMsgPtrQueue::Entry queue_buf[],
+                                 size_t queue_length,
+                                 Callback callback, OverflowPolicy policy,
+                                 TimestampedMsgPtrQueue::Kind queue_kind)
 :
   BaseSubscriber(),
   nodep(NULL),
   callback(callback),
-  msgp_queue(queue_buf, queue_length),
+  tmsgp_queue(queue_buf, queue_length, queue_kind),
   event_index(~0),
+  policy(static_cast<uint_least8_t>(policy)),
+  num_expired(0),
   by_node(*this),
   by_topic(*this)
 {
   R2P_ASSERT(queue_buf != NULL);
   R2P_ASSERT(queue_length > 0);
+  // Evicting from the notifier side would make it a second consumer
+  R2P_ASSERT(queue_kind == TimestampedMsgPtrQueue::ARRAY ||
+             policy == DROP_NEWEST);
 }
 
 
@@ -0,0 +1,71 @@
+#include <r2p/MessageSlab.hpp>
+
+namespace r2p {
+
+
+MessageSlab MessageSlab::instance;
+
+
+size_t MessageSlab::find_class(size_t type_size) {
+
+  R2P_ASSERT(type_size >= sizeof(SimplePool_::Header));
+  R2P_ASSERT(type_size <= 0xFFFF);
+
+  SysLock::acquire();
+  for (size_t index = 0; index < NUM_CLASSES; ++index) {
+    if (block_sizes[index] == 0) {
+      block_sizes[index] = static_cast<uint16_t>(type_size);
+    }
+    if (block_sizes[index] == type_size) {
+      SysLock::release();
+      return index;
+    }
+  }
+  SysLock::release();
+  R2P_ASSERT(false); // Raise R2P_SLAB_NUM_CLASSES
+  return NUM_CLASSES - 1;
+}
+
+
+bool MessageSlab::wait_free_unsafe(const Time &timeout) {
+
+  bool signaled;
+  ++num_free_waiters;
+  if (timeout == Time::INFINITE) {
+    free_sem.wait_unsafe();
+    signaled = true;
+  } else {
+    signaled = free_sem.wait_unsafe(timeout);
+  }
+  if (--num_free_waiters == 0) {
+    free_sem.reset_unsafe();
+  }
+  return signaled;
+}
+
+
+size_t MessageSlab::grow(size_t index, void *bufp, size_t buflen) {
+
+  R2P_ASSERT(bufp != NULL);
+
+  // Carve whole blocks only, the tail of the buffer is left unused
+  const size_t length = buflen / get_block_size(index);
+  if (length > 0) {
+    pools[index].grow(bufp, length, get_block_size(index));
+  }
+  return length;
+}
+
+
+MessageSlab::MessageSlab()
+:
+  free_sem(0),
+  num_free_waiters(0)
+{
+  for (size_t index = 0; index < NUM_CLASSES; ++index) {
+    block_sizes[index] = 0;
+  }
+}
+
+
+} // namespace r2p
@@ -43,10 +43,10 @@ void Middleware::initialize(void *mgmt_stackp, size_t mgmt_stacklen,
     R2P_ASSERT(boot_stackp != NULL);
     R2P_ASSERT(boot_stacklen > 0);
 
-    topics.link(boot_topic.by_middleware);
+    link_topic(boot_topic);
   }
 #endif
-  topics.link(mgmt_topic.by_middleware);
+  link_topic(mgmt_topic);
 }
 
 
@@ -132,6 +132,41 @@ bool Middleware::reboot_remote(const char *namep, bool bootload) {
 }
 
 
+#if R2P_USE_LATENCY_HISTOGRAMS
+bool Middleware::request_latency_remote(const char *namep) {
+
+  MgmtMsg *msgp;
+  if (mgmt_pub.alloc(msgp)) {
+    Message::reset_payload(*msgp);
+    msgp->type = MgmtMsg::LATENCY_REQUEST;
+    strncpy(msgp->module.name, namep, NamingTraits<Middleware>::MAX_LENGTH);
+    return mgmt_pub.publish_remotely(*msgp);
+  }
+  return false;
+}
+#endif
+
+
+#if R2P_USE_TRAFFIC_COUNTERS
+bool Middleware::request_traffic_remote(const char *namep,
+                                        const Time &period) {
+
+  MgmtMsg *msgp;
+  if (mgmt_pub.alloc(msgp)) {
+    Message::reset_payload(*msgp);
+    msgp->type = MgmtMsg::TRAFFIC_REQUEST;
+    strncpy(msgp->traffic_request.module, namep,
+            NamingTraits<Middleware>::MAX_LENGTH);
+    msgp->traffic_request.period_ms = static_cast<uint16_t>(
+      (period.to_ms_raw() < 0xFFFF) ? period.to_ms_raw() : 0xFFFF
+    );
+    return mgmt_pub.publish_remotely(*msgp);
+  }
+  return false;
+}
+#endif
+
+
 void Middleware::add(Node &node) {
 
   SysLock::acquire();
@@ -151,7 +186,7 @@ void Middleware::add(Topic &topic) {
 
   R2P_ASSERT(find_topic(topic.get_name()) == NULL);
 
-  topics.link(topic.by_middleware);
+  link_topic(topic);
 }
 
 
@@ -171,12 +206,16 @@ bool Middleware::advertise(LocalPublisher &pub, const char *namep,
 
     MgmtMsg *msgp;
     if (mgmt_pub.alloc(msgp)) {
+      Message::reset_payload(*msgp);
       msgp->type = MgmtMsg::ADVERTISE;
       strncpy(msgp->pubsub.topic, topicp->get_name(),
               NamingTraits<Topic>::MAX_LENGTH);
       msgp->pubsub.payload_size =
         static_cast<uint16_t>(topicp->get_payload_size());
-     mgmt_pub.publish_remotely(*msgp);
+      // Each transport gets a copy with its own raw parameters
+      msgp->acquire();
+      mgmt_topic.forward_copy(*msgp, mgmt_topic.compute_deadline());
+      mgmt_sub.release(*msgp);
     }
   }
   return true;
@@ -210,22 +249,23 @@ bool Middleware::subscribe(LocalSubscriber &sub, const char *namep,
   lists_lock.release();
 
   if (topicp != &mgmt_topic) {
-    for (StaticList<Transport>::Iterator i = transports.begin();
-        i != transports.end(); ++i) {
-      { SysLock::Scope lock;
-      if (mgmt_pub.get_topic() == NULL) return true; }
-
-      MgmtMsg *msgp;
-      if (mgmt_pub.alloc(msgp)) {
-        msgp->type = MgmtMsg::SUBSCRIBE_REQUEST;
-        strncpy(msgp->pubsub.topic, topicp->get_name(),
-                NamingTraits<Topic>::MAX_LENGTH);
-        msgp->pubsub.payload_size =
-            static_cast<uint16_t>(topicp->get_payload_size());
-        msgp->pubsub.queue_length =
-            static_cast<uint16_t>(msgpool_buflen);
-        mgmt_pub.publish_remotely(*msgp);
-      }
+    { SysLock::Scope lock;
+    if (mgmt_pub.get_topic() == NULL) return true; }
+
+    MgmtMsg *msgp;
+    if (mgmt_pub.alloc(msgp)) {
+      Message::reset_payload(*msgp);
+      msgp->type = MgmtMsg::SUBSCRIBE_REQUEST;
+      strncpy(msgp->pubsub.topic, topicp->get_name(),
+              NamingTraits<Topic>::MAX_LENGTH);
+      msgp->pubsub.payload_size =
+          static_cast<uint16_t>(topicp->get_payload_size());
+      msgp->pubsub.queue_length =
+          static_cast<uint16_t>(msgpool_buflen);
+      // Each transport gets a copy with its own raw parameters
+      msgp->acquire();
+      mgmt_topic.forward_copy(*msgp, mgmt_topic.compute_deadline());
+      mgmt_sub.release(*msgp);
     }
   }
   return true;
@@ -264,7 +304,11 @@ void Middleware::confirm_stop(const Node &node) {
 Topic *Middleware::find_topic(const char *namep) {
 
   lists_lock.acquire();
-  Topic *topicp = topics.find_first(Topic::has_name, namep);
+  Topic *topicp = topic_index.find(namep);
+  if (topicp == NULL && !topic_index.is_complete()) {
+    // Some topics did not fit into the index
+    topicp = topics.find_first(Topic::has_name, namep);
+  }
   lists_lock.release();
   return topicp;
 }
@@ -279,6 +323,15 @@ Node *Middleware::find_node(const char *namep) {
 }
 
 
+void Middleware::link_topic(Topic &topic) {
+
+  lists_lock.acquire();
+  topics.link(topic.by_middleware);
+  topic_index.insert(topic);
+  lists_lock.release();
+}
+
+
 Topic *Middleware::touch_topic(const char *namep, size_t type_size) {
 
   lists_lock.acquire();
@@ -289,7 +342,7 @@ Topic *Middleware::touch_topic(const char *namep, size_t type_size) {
     // Allocate a new topic
     topicp = new Topic(namep, type_size);
     if (topicp != NULL) {
-      topics.link(topicp->by_middleware);
+      link_topic(*topicp);
     }
   }
 
@@ -392,6 +445,32 @@ void Middleware::do_mgmt_thread() {
           }
 // [MARTINO]
 //          mgmt_topic.notify_remotes(*msgp, deadline);
+#if R2P_USE_BRIDGE_MODE
+          mgmt_topic.forward_copy(*msgp, deadline);
+#endif // R2P_USE_BRIDGE_MODE
+          mgmt_sub.release(*msgp);
+          break;
+        }
+#endif
+#if R2P_USE_LATENCY_HISTOGRAMS
+        case MgmtMsg::LATENCY_REQUEST: {
+          if (0 == strncmp(module_namep, msgp->module.name,
+                           NamingTraits<Middleware>::MAX_LENGTH)) {
+            do_cmd_latency_request(*msgp);
+          }
+#if R2P_USE_BRIDGE_MODE
+          mgmt_topic.forward_copy(*msgp, deadline);
+#endif // R2P_USE_BRIDGE_MODE
+          mgmt_sub.release(*msgp);
+          break;
+        }
+#endif
+#if R2P_USE_TRAFFIC_COUNTERS
+        case MgmtMsg::TRAFFIC_REQUEST: {
+          if (0 == strncmp(module_namep, msgp->traffic_request.module,
+                           NamingTraits<Middleware>::MAX_LENGTH)) {
+            do_cmd_traffic_request(*msgp);
+          }
 #if R2P_USE_BRIDGE_MODE
           mgmt_topic.forward_copy(*msgp, deadline);
 #endif // R2P_USE_BRIDGE_MODE
@@ -490,6 +569,19 @@ void Middleware::do_mgmt_thread() {
       }
     }
 #endif // R2P_ITERATE_PUBSUB
+#if R2P_USE_LATENCY_HISTOGRAMS
+    // Resume a latency report stopped by an empty pool
+    if (latency_pending) {
+      publish_latency();
+    }
+#endif
+#if R2P_USE_TRAFFIC_COUNTERS
+    // Stream the traffic counters, if requested
+    if (traffic_period != Time::IMMEDIATE &&
+        Time::now() - traffic_lasttime >= traffic_period) {
+      publish_traffic();
+    }
+#endif
   }
 }
 
@@ -523,6 +615,7 @@ void Middleware::do_cmd_advertise(const MgmtMsg &msg) {
 #if R2P_USE_BRIDGE_MODE
       mgmt_topic.forward_copy(*msgp, topicp->compute_deadline());
 #else // R2P_USE_BRIDGE_MODE
+      transports.begin()->fill_raw_params(*topicp, msgp->pubsub.raw_params);
       mgmt_pub.publish_remotely(*msgp);
 #endif // R2P_USE_BRIDGE_MODE
       mgmt_sub.release(*msgp);
@@ -673,6 +766,219 @@ void Middleware::do_cmd_subscribe_response(const MgmtMsg &msg) {
 }
 
 
+#if R2P_USE_LATENCY_HISTOGRAMS || R2P_USE_TRAFFIC_COUNTERS
+void Middleware::publish_report(MgmtMsg *msgp) {
+
+  if (msgp != NULL) {
+    msgp->acquire();
+    mgmt_pub.publish_remotely(*msgp);
+    mgmt_sub.release(*msgp);
+  }
+}
+#endif
+
+
+#if R2P_USE_LATENCY_HISTOGRAMS
+void Middleware::do_cmd_latency_request(const MgmtMsg &msg) {
+
+  (void)msg;
+
+  // A report still in progress is cut short, and ends without the flag
+  latency_pending = true;
+  latency_chunk = 0;
+  publish_latency();
+}
+
+
+void Middleware::publish_latency() {
+
+  enum {
+    NUM_CHUNKS = (LatencyHistogram::NUM_BUCKETS +
+                  MgmtMsg::Latency::MAX_COUNTS - 1) /
+                 MgmtMsg::Latency::MAX_COUNTS
+  };
+
+  // One response per chunk of buckets, for each local subscriber. Each is
+  // sent once the next one is ready, so that the last can be flagged. The
+  // management messages are not waited for: the report stops when the pool
+  // is empty, and resumes from the same chunk on the next pass.
+  const char *topic_namep;
+  LatencyHistogram::Count counts[MgmtMsg::Latency::MAX_COUNTS];
+  for (;;) {
+    const size_t first = (latency_chunk % NUM_CHUNKS) *
+                         MgmtMsg::Latency::MAX_COUNTS;
+    if (!snapshot_local_latency(latency_chunk / NUM_CHUNKS, first,
+                                topic_namep, counts)) break;
+
+    MgmtMsg *msgp;
+    if (!mgmt_pub.alloc(msgp)) return;
+    Message::reset_payload(*msgp);
+    msgp->type = MgmtMsg::LATENCY_RESPONSE;
+    strncpy(msgp->latency.topic, topic_namep,
+            NamingTraits<Topic>::MAX_LENGTH);
+    msgp->latency.first_bucket = static_cast<uint8_t>(first);
+    for (size_t i = 0; i < MgmtMsg::Latency::MAX_COUNTS &&
+         first + i < LatencyHistogram::NUM_BUCKETS; ++i) {
+      msgp->latency.counts[i] = counts[i];
+    }
+    publish_report(latency_lastp);
+    latency_lastp = msgp;
+    ++latency_chunk;
+  }
+  if (latency_lastp != NULL) {
+    latency_lastp->latency.first_bucket |= MgmtMsg::Latency::LAST;
+    publish_report(latency_lastp);
+    latency_lastp = NULL;
+  }
+  latency_pending = false;
+}
+
+
+// Walked like the traffic counters, the buckets are copied under the lock
+// that guards their updates.
+bool Middleware::snapshot_local_latency(size_t index, size_t first,
+                                        const char *&topic_namep,
+                                        LatencyHistogram::Count counts[]) {
+
+  SysLock::acquire();
+  for (StaticList<Node>::IteratorUnsafe ni = nodes.begin_unsafe();
+       ni != nodes.end_unsafe(); ++ni) {
+    if (&*ni == &mgmt_node) continue;
+    for (StaticList<LocalSubscriber>::ConstIteratorUnsafe si =
+         ni->get_subscribers().begin_unsafe();
+         si != ni->get_subscribers().end_unsafe(); ++si) {
+      if (index-- == 0) {
+        topic_namep = si->get_topic()->get_name();
+        for (size_t i = 0; i < MgmtMsg::Latency::MAX_COUNTS &&
+             first + i < LatencyHistogram::NUM_BUCKETS; ++i) {
+          counts[i] = si->get_latency().get_count(first + i);
+        }
+        SysLock::release();
+        return true;
+      }
+    }
+  }
+  SysLock::release();
+  return false;
+}
+#endif // R2P_USE_LATENCY_HISTOGRAMS
+
+
+#if R2P_USE_TRAFFIC_COUNTERS
+void Middleware::do_cmd_traffic_request(const MgmtMsg &msg) {
+
+  traffic_period = Time::ms(msg.traffic_request.period_ms);
+  publish_traffic();
+}
+
+
+void Middleware::publish_traffic() {
+
+  traffic_lasttime = Time::now();
+  TrafficCounters counters;
+
+  // Paced and flagged like the latency reports. Each entry is copied under
+  // the locks, which are released while waiting for a management message.
+  // Topics are never unlinked, so the walk resumes where it left off; the
+  // lock keeps the lists still while it steps.
+  MgmtMsg *lastp = NULL;
+  lists_lock.acquire();
+  for (StaticList<Topic>::Iterator ti = topics.begin();
+       ti != topics.end(); ++ti) {
+    SysLock::acquire();
+    counters = ti->get_counters();
+    SysLock::release();
+    lists_lock.release();
+    if (!publish_traffic(lastp, ti->get_name(), MgmtMsg::Traffic::TOPIC,
+                         counters)) return;
+    lists_lock.acquire();
+
+    for (StaticList<RemoteSubscriber>::Iterator si =
+         ti->remote_subscribers.begin();
+         si != ti->remote_subscribers.end(); ++si) {
+      SysLock::acquire();
+      counters = si->get_counters();
+      SysLock::release();
+      lists_lock.release();
+      if (!publish_traffic(lastp, ti->get_name(),
+                           MgmtMsg::Traffic::REMOTE_SUBSCRIBER,
+                           counters)) return;
+      lists_lock.acquire();
+    }
+  }
+  lists_lock.release();
+
+  const char *topic_namep;
+  for (size_t index = 0;
+       snapshot_local_traffic(index, topic_namep, counters); ++index) {
+    if (!publish_traffic(lastp, topic_namep,
+                         MgmtMsg::Traffic::LOCAL_SUBSCRIBER,
+                         counters)) return;
+  }
+
+  if (lastp != NULL) {
+    lastp->traffic.source |= MgmtMsg::Traffic::LAST;
+    publish_report(lastp);
+  }
+}
+
+
+// Nodes are unlinked when they stop, and may be gone by the next call: the
+// walk starts over and counts up to the index-th local subscriber.
+bool Middleware::snapshot_local_traffic(size_t index, const char *&topic_namep,
+                                        TrafficCounters &counters) {
+
+  SysLock::acquire();
+  for (StaticList<Node>::IteratorUnsafe ni = nodes.begin_unsafe();
+       ni != nodes.end_unsafe(); ++ni) {
+    if (&*ni == &mgmt_node) continue;
+    for (StaticList<LocalSubscriber>::ConstIteratorUnsafe si =
+         ni->get_subscribers().begin_unsafe();
+         si != ni->get_subscribers().end_unsafe(); ++si) {
+      if (index-- == 0) {
+        topic_namep = si->get_topic()->get_name();
+        counters = si->get_counters();
+        SysLock::release();
+        return true;
+      }
+    }
+  }
+  SysLock::release();
+  return false;
+}
+
+
+bool Middleware::publish_traffic(MgmtMsg *&lastp, const char *topicp,
+                                 uint8_t source,
+                                 const TrafficCounters &counters) {
+
+  MgmtMsg *msgp;
+  if (!mgmt_pub.alloc(msgp, Time::ms(MGMT_TIMEOUT_MS))) {
+    publish_report(lastp);
+    lastp = NULL;
+    return false;
+  }
+
+  Message::reset_payload(*msgp);
+  msgp->type = MgmtMsg::TRAFFIC_RESPONSE;
+  strncpy(msgp->traffic.topic, topicp, NamingTraits<Topic>::MAX_LENGTH);
+  msgp->traffic.source = source;
+  msgp->traffic.publishes = counters.publishes;
+  msgp->traffic.deliveries = counters.deliveries;
+  msgp->traffic.queue_drops = static_cast<uint16_t>(
+    (counters.queue_drops < 0xFFFF) ? counters.queue_drops : 0xFFFF
+  );
+  msgp->traffic.alloc_failures = static_cast<uint16_t>(
+    (counters.alloc_failures < 0xFFFF) ? counters.alloc_failures : 0xFFFF
+  );
+  msgp->traffic.max_queue_depth = counters.max_queue_depth;
+  publish_report(lastp);
+  lastp = msgp;
+  return true;
+}
+#endif // R2P_USE_TRAFFIC_COUNTERS
+
+
 #if R2P_USE_BRIDGE_MODE
 
 Middleware::PubSubStep *Middleware::alloc_pubsub_step() {
@@ -706,10 +1012,14 @@ Middleware::PubSubStep *Middleware::alloc_pubsub_step() {
 
 
 Middleware::Middleware(const char *module_namep, const char *bootloader_namep,
-                       PubSubStep pubsub_buf[], size_t pubsub_length)
+                       PubSubStep pubsub_buf[], size_t pubsub_length,
+                       Topic *topic_index_buf[], size_t topic_index_length)
 :
   module_namep(module_namep),
+  topic_index(topic_index_buf, topic_index_length),
   lists_lock(false),
+  stopped(false),
+  num_running_nodes(0),
   mgmt_topic("R2P", sizeof(MgmtMsg), false),
   mgmt_stackp(NULL),
   mgmt_stacklen(0),
@@ -717,20 +1027,27 @@ Middleware::Middleware(const char *module_namep, const char *bootloader_namep,
   mgmt_priority(Thread::LOWEST),
   mgmt_node("R2P_MGMT", false),
   mgmt_pub(),
-  mgmt_sub(mgmt_queue_buf, MGMT_BUFFER_LENGTH, NULL),
+  mgmt_sub(mgmt_queue_buf, MGMT_BUFFER_LENGTH, NULL)
 #if R2P_USE_BOOTLOADER
-  boot_topic(bootloader_namep, sizeof(BootMsg)),
+  , boot_topic(bootloader_namep, sizeof(BootMsg)),
   boot_stackp(NULL),
   boot_stacklen(0),
   boot_threadp(NULL),
-  boot_priority(Thread::LOWEST),
+  boot_priority(Thread::LOWEST)
 #endif
 #if R2P_USE_BRIDGE_MODE
-  pubsub_stepsp(NULL),
-  pubsub_pool(pubsub_buf, pubsub_length),
+  , pubsub_stepsp(NULL),
+  pubsub_pool(pubsub_buf, pubsub_length)
+#endif
+#if R2P_USE_LATENCY_HISTOGRAMS
+  , latency_pending(false),
+  latency_chunk(0),
+  latency_lastp(NULL)
+#endif
+#if R2P_USE_TRAFFIC_COUNTERS
+  , traffic_period(Time::IMMEDIATE),
+  traffic_lasttime(Time::IMMEDIATE)
 #endif
-  stopped(false),
-  num_running_nodes(0)
 {
 	R2P_ASSERT(is_identifier(module_namep,
 	                         NamingTraits<Middleware>::MAX_LENGTH));
@@ -754,7 +1071,7 @@ Thread::Return Middleware::boot_threadf(Thread::Argument) {
   R2P_ASSERT(flash_page_bufp != NULL);
 
   BootMsg msgbuf[BOOT_BUFFER_LENGTH];
-  BootMsg *msgqueue_buf[BOOT_BUFFER_LENGTH];
+  TimestampedMsgPtrQueue::Entry msgqueue_buf[BOOT_BUFFER_LENGTH];
   SubscriberExtBuf<BootMsg> sub(msgqueue_buf, BOOT_BUFFER_LENGTH);
   Publisher<BootMsg> pub;
 
@@ -32,11 +32,13 @@ bool Node::subscribe(LocalSubscriber &sub, const char *namep,
   int index = subscribers.count();
   subscribers.link(sub.by_node);
   R2P_ASSERT(index >= 0);
-  R2P_ASSERT(index <= static_cast<int>(SpinEvent::MAX_INDEX));
-  sub.event_index = static_cast<uint_least8_t>(index);
+  R2P_ASSERT(index < static_cast<int>(MAX_SUBSCRIBERS)); // Raise it
+  sub.event_index = static_cast<uint_least16_t>(index);
+  event_subscribers[index] = &sub;
 
   if (!Middleware::instance.subscribe(sub, namep, msgpool_buf,
                                      sub.get_queue_length(), msg_size)) {
+    event_subscribers[index] = NULL;
     subscribers.unlink(sub.by_node);
     return false;
   }
@@ -48,30 +50,119 @@ bool Node::subscribe(LocalSubscriber &sub, const char *namep,
 
 bool Node::spin(const Time &timeout) {
 
-  SpinEvent::Mask mask;
-  mask = event.wait(timeout);
+  SpinEvent::Mask masks[SpinEvent::NUM_GROUPS];
+  SpinEvent::Mask summary;
+  summary = event.wait(timeout, masks);
 
-  if (mask == 0) {
+  if (summary == 0) {
 	  return false;
   }
 
-  Time dummy_timestamp;
-  SpinEvent::Mask bit = 1;
-  for (StaticList<LocalSubscriber>::Iterator i = subscribers.begin();
-       i != subscribers.end() && mask != 0; bit <<= 1, ++i) {
-    if ((mask & bit) != 0) {
-      mask &= ~bit;
-      const LocalSubscriber::Callback callback = i->get_callback();
-      if (callback != NULL) {
-        Message *msgp;
-        while (i->fetch(msgp, dummy_timestamp)) {
-          (*callback)(*msgp);
-          i->release(*msgp);
-        }
+  dispatch(summary, masks);
+  return true;
+}
+
+
+void Node::dispatch(SpinEvent::Mask summary, SpinEvent::Mask masks[]) {
+
+  // Earliest deadline first, one batch at a time, one lock to fetch it and
+  // one to release it once its callbacks have run
+  TimestampedMsgPtrQueue::Entry batch[R2P_NODE_SPIN_BATCH_LENGTH];
+#if R2P_USE_LATENCY_HISTOGRAMS
+  Time latencies[R2P_NODE_SPIN_BATCH_LENGTH];
+#endif
+  LocalSubscriber *subp;
+  while ((subp = select_earliest(summary, masks)) != NULL) {
+    const LocalSubscriber::Callback callback = subp->get_callback();
+    const Topic &topic = *subp->get_topic();
+    size_t count = subp->fetch_n(batch, R2P_NODE_SPIN_BATCH_LENGTH);
+    for (size_t k = 0; k < count; ++k) {
+      const Time now = Time::now();
+#if R2P_USE_LATENCY_HISTOGRAMS
+      latencies[k] = now - batch[k].timestamp;
+#endif
+      if (topic.compute_slack_unsafe(batch[k].timestamp, now) <
+          Time::IMMEDIATE) {
+        ++subp->num_expired; // Stale, drop it without calling back
+      } else {
+        (*callback)(*batch[k].msgp);
       }
     }
+#if R2P_USE_LATENCY_HISTOGRAMS
+    // The management thread reads the histogram under SysLock, update it
+    // along with the release
+    SysLock::acquire();
+    for (size_t k = 0; k < count; ++k) {
+      subp->latency.update(latencies[k]);
+    }
+    subp->release_n_unsafe(batch, count);
+    SysLock::release();
+#else
+    subp->release_n(batch, count);
+#endif
   }
-  return true;
+}
+
+
+void Node::dispatch_all() {
+
+  // No event masks when run by an executor, just look at every queue
+  SpinEvent::Mask masks[SpinEvent::NUM_GROUPS];
+  SpinEvent::Mask summary = 0;
+  for (unsigned group = 0; group < SpinEvent::NUM_GROUPS; ++group) {
+    const unsigned first = group * SpinEvent::MASK_WIDTH;
+    masks[group] = 0;
+    if (first >= MAX_SUBSCRIBERS) continue;
+    if (MAX_SUBSCRIBERS - first >= SpinEvent::MASK_WIDTH) {
+      masks[group] = ~static_cast<SpinEvent::Mask>(0);
+    } else {
+      masks[group] = (static_cast<SpinEvent::Mask>(1) <<
+                      (MAX_SUBSCRIBERS - first)) - 1;
+    }
+    summary |= static_cast<SpinEvent::Mask>(1) << group;
+  }
+  dispatch(summary, masks);
+}
+
+
+LocalSubscriber *Node::select_earliest(SpinEvent::Mask &summary,
+                                       SpinEvent::Mask masks[]) {
+
+  LocalSubscriber *bestp = NULL;
+  Time best_slack;
+  const Time now = Time::now();
+  TimestampedMsgPtrQueue::Entry head;
+
+  // Visit only the set bits of the signaled groups, lowest first
+  SysLock::acquire();
+  for (SpinEvent::Mask groups = summary; groups != 0; groups &= groups - 1) {
+    const unsigned group = SpinEvent::lowest_index(groups);
+    SpinEvent::Mask &mask = masks[group];
+    for (SpinEvent::Mask pending = mask; pending != 0;
+         pending &= pending - 1) {
+      const unsigned bit = SpinEvent::lowest_index(pending);
+      const unsigned index = group * SpinEvent::MASK_WIDTH + bit;
+      // Indexes past the table are only the stop event
+      LocalSubscriber *subp =
+        (index < MAX_SUBSCRIBERS) ? event_subscribers[index] : NULL;
+      if (subp == NULL || subp->get_callback() == NULL ||
+          !subp->peek_unsafe(head)) {
+        mask &= ~(static_cast<SpinEvent::Mask>(1) << bit);
+        continue; // Nothing left to dispatch
+      }
+      const Time slack =
+        subp->get_topic()->compute_slack_unsafe(head.timestamp, now);
+      if (bestp == NULL || slack < best_slack) {
+        bestp = subp;
+        best_slack = slack;
+      }
+    }
+    if (mask == 0) {
+      summary &= ~(static_cast<SpinEvent::Mask>(1) << group);
+    }
+  }
+  SysLock::release();
+  return bestp;
 }
 
 
@@ -79,9 +170,18 @@ Node::Node(const char *namep, bool enabled)
 :
   namep(namep),
   event(enabled ? &Thread::self() : NULL),
+  executorp(NULL),
+  exec_state(IDLE),
+  exec_worker(0),
+  enabled(enabled),
   by_middleware(*this)
 {
   R2P_ASSERT(is_identifier(namep, NamingTraits<Node>::MAX_LENGTH));
+  R2P_ASSERT(MAX_SUBSCRIBERS <= SpinEvent::MAX_INDEX + 1);
+
+  for (unsigned i = 0; i < MAX_SUBSCRIBERS; ++i) {
+    event_subscribers[i] = NULL;
+  }
 
   Middleware::instance.add(*this);
 }
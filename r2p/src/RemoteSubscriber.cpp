@@ -1,15 +1,50 @@
 
 #include <r2p/RemoteSubscriber.hpp>
+#include <r2p/Transport.hpp>
 
 namespace r2p {
 
 
-RemoteSubscriber::RemoteSubscriber(Transport &transport)
+bool RemoteSubscriber::fetch_unsafe(Message *&msgp, Time &timestamp) {
+
+  TimestampedMsgPtrQueue::Entry entry;
+  if (tmsgp_queue.fetch_unsafe(entry)) {
+    msgp = entry.msgp;
+    timestamp = entry.timestamp;
+    return true;
+  }
+  return false;
+}
+
+
+bool RemoteSubscriber::notify_unsafe(Message &msg, const Time &timestamp) {
+
+  TimestampedMsgPtrQueue::Entry entry(&msg, timestamp);
+
+  if (tmsgp_queue.post_unsafe(entry)) {
+#if R2P_USE_TRAFFIC_COUNTERS
+    counters.update_queue_depth(tmsgp_queue.get_count());
+#endif
+    transportp->notify_tx_unsafe(*this);
+    return true;
+  }
+  return false;
+}
+
+
+RemoteSubscriber::RemoteSubscriber(Transport &transport,
+                                   TimestampedMsgPtrQueue::Entry queue_buf[],
+                                   size_t queue_length,
+                                   TimestampedMsgPtrQueue::Kind queue_kind)
 :
   BaseSubscriber(),
   transportp(&transport),
+  tmsgp_queue(queue_buf, queue_length, queue_kind),
   by_transport(*this),
-  by_topic(*this)
+  by_topic(*this),
+  tx_leftp(NULL),
+  tx_rightp(NULL),
+  tx_weight(0)
 {}
 
 
@@ -17,4 +52,3 @@ RemoteSubscriber::~RemoteSubscriber() {}
 
 
 } // namespace r2p
-
@@ -4,6 +4,15 @@
 namespace r2p {
 
 
+const Time::Type Time::MAX_US;
+const Time::Type Time::MIN_US;
+const Time::Type Time::MIN_MS;
+const Time::Type Time::MAX_MS;
+const Time::Type Time::MIN_S;
+const Time::Type Time::MAX_S;
+const Time::Type Time::MIN_M;
+const Time::Type Time::MAX_M;
+
 const Time Time::IMMEDIATE(0);
 const Time Time::INFINITE(MAX_US + 1);
 const Time Time::INFINITEN(MIN_US - 1);
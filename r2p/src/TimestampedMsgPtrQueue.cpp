@@ -1,13 +1,44 @@
 
 #include <r2p/TimestampedMsgPtrQueue.hpp>
+#if R2P_USE_SPSC_QUEUES || R2P_USE_MPSC_QUEUES
+#include <new>
+#endif
 
 namespace r2p {
 
 
-TimestampedMsgPtrQueue::TimestampedMsgPtrQueue(Entry array[], size_t length)
+#if R2P_USE_SPSC_QUEUES || R2P_USE_MPSC_QUEUES
+
+TimestampedMsgPtrQueue::TimestampedMsgPtrQueue(Entry array[], size_t length,
+                                               Kind kind)
+:
+  kind(static_cast<uint_least8_t>(kind))
+{
+  switch (kind) {
+#if R2P_USE_SPSC_QUEUES
+  case SPSC: new (impl.spsc_buf) SpscQueue<Entry>(array, length); break;
+#endif
+#if R2P_USE_MPSC_QUEUES
+  case MPSC: new (impl.mpsc_buf) MpscQueue<Entry>(array, length); break;
+#endif
+  default:
+    R2P_ASSERT(false); // Kind not built in, fall back to ArrayQueue
+  case ARRAY: new (impl.array_buf) ArrayQueue<Entry>(array, length); break;
+  }
+}
+
+#else
+
+TimestampedMsgPtrQueue::TimestampedMsgPtrQueue(Entry array[], size_t length,
+                                               Kind kind)
 :
   impl(array, length)
-{}
+{
+  R2P_ASSERT(kind == ARRAY);
+  (void)kind;
+}
+
+#endif // R2P_USE_SPSC_QUEUES || R2P_USE_MPSC_QUEUES
 
 
 } // namespace r2p
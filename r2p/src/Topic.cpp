@@ -4,30 +4,58 @@
 #include <r2p/NamingTraits.hpp>
 #include <r2p/Message.hpp>
 #include <r2p/Transport.hpp>
+#include <r2p/TopicIndex.hpp>
 
 namespace r2p {
 
 
+// The refcount is raised once, after the loop, for all the successful
+// notifications. This is safe only because:
+// - the caller holds a reference, so the message is not freed meanwhile;
+// - subscribers release only under SysLock, which is held until the end.
+// A notify_unsafe() that released or freed the message would break this.
 bool Topic::notify_locals_unsafe(Message &msg, const Time &timestamp) {
 
+  R2P_ASSERT(msg.get_refcount_unsafe() > 0);
+
   if (has_local_subscribers()) {
+    const Message::RefcountType refcount = msg.get_refcount_unsafe();
+    (void)refcount;
+    register size_t count = 0;
     for (StaticList<LocalSubscriber>::IteratorUnsafe i =
          local_subscribers.begin_unsafe();
          i != local_subscribers.end_unsafe(); ++i) {
-      msg.acquire_unsafe();
-      if (!i->notify_unsafe(msg, timestamp)) {
-        msg.release_unsafe();
+      if (i->notify_unsafe(msg, timestamp)) {
+        ++count;
+#if R2P_USE_TRAFFIC_COUNTERS
+        ++i->counters.deliveries;
+      } else {
+        ++i->counters.queue_drops;
+        ++counters.queue_drops;
+#endif
       }
     }
+    R2P_ASSERT(msg.get_refcount_unsafe() == refcount);
+    msg.acquire_n_unsafe(count);
+#if R2P_USE_TRAFFIC_COUNTERS
+    counters.deliveries += count;
+#endif
   }
 
   return true;
 }
 
 
+// Same deferred refcount update as notify_locals_unsafe()
 bool Topic::notify_remotes_unsafe(Message &msg, const Time &timestamp) {
 
+  R2P_ASSERT(msg.get_refcount_unsafe() > 0);
+
   if (has_remote_subscribers()) {
+    const Message::RefcountType refcount = msg.get_refcount_unsafe();
+    (void)refcount;
+    register size_t count = 0;
+    Transport *flushp = NULL;
     for (StaticList<RemoteSubscriber>::IteratorUnsafe i =
          remote_subscribers.begin_unsafe();
          i != remote_subscribers.end_unsafe(); ++i) {
@@ -39,11 +67,26 @@ bool Topic::notify_remotes_unsafe(Message &msg, const Time &timestamp) {
       }
 #endif
 
-      msg.acquire_unsafe();
-      if (!i->notify_unsafe(msg, timestamp)) {
-        msg.release_unsafe();
+      if (i->notify_unsafe(msg, timestamp)) {
+        ++count;
+        i->get_transport()->link_tx_flush_unsafe(flushp);
+#if R2P_USE_TRAFFIC_COUNTERS
+        ++i->counters.deliveries;
+      } else {
+        ++i->counters.queue_drops;
+        ++counters.queue_drops;
+#endif
       }
     }
+    R2P_ASSERT(msg.get_refcount_unsafe() == refcount);
+    msg.acquire_n_unsafe(count);
+#if R2P_USE_TRAFFIC_COUNTERS
+    counters.deliveries += count;
+#endif
+
+    // Transports without a TX thread send right away, which is safe only
+    // now that the references are taken; once per notified transport
+    Transport::flush_tx_list_unsafe(flushp);
   }
 
   return true;
@@ -53,6 +96,8 @@ bool Topic::notify_remotes_unsafe(Message &msg, const Time &timestamp) {
 bool Topic::forward_copy_unsafe(const Message &msg, const Time &timestamp) {
 
   bool all = true;
+  const bool patching = requires_patching(msg);
+  Transport *flushp = NULL;
 
   for (StaticList<RemoteSubscriber>::IteratorUnsafe i =
          remote_subscribers.begin_unsafe();
@@ -65,6 +110,19 @@ bool Topic::forward_copy_unsafe(const Message &msg, const Time &timestamp) {
     }
 #endif
 
+    if (!patching) {
+      // Same contents for every transport, share the message
+      Message &shared = const_cast<Message &>(msg);
+      shared.acquire_unsafe();
+      if (!i->notify_unsafe(shared, timestamp)) {
+        shared.release_unsafe();
+        all = false;
+      } else {
+        i->get_transport()->link_tx_flush_unsafe(flushp);
+      }
+      continue;
+    }
+
     Message *msgp;
     if (alloc_unsafe(msgp)) {
       Message::copy(*msgp, msg, get_type_size());
@@ -73,12 +131,15 @@ bool Topic::forward_copy_unsafe(const Message &msg, const Time &timestamp) {
       if (!i->notify_unsafe(*msgp, timestamp)) {
         free_unsafe(*msgp);
         all = false;
+      } else {
+        i->get_transport()->link_tx_flush_unsafe(flushp);
       }
     } else {
       all = false;
     }
   }
 
+  Transport::flush_tx_list_unsafe(flushp);
   return all;
 }
 
@@ -92,6 +153,39 @@ Message *Topic::alloc() {
 }
 
 
+Message *Topic::alloc(const Time &timeout) {
+
+  const bool forever = (timeout == Time::INFINITE);
+  const Time deadline = forever ? Time::INFINITE : Time::now() + timeout;
+  SysLock::acquire();
+  Message *msgp;
+  while ((msgp = alloc_unsafe()) == NULL && timeout != Time::IMMEDIATE) {
+    // Wait for a free(), then retry; wakeups may be spurious
+    const Time left = forever ? Time::INFINITE : deadline - Time::now();
+    if (left <= Time::IMMEDIATE) break;
+#if R2P_USE_SHARED_MSG_POOL
+    // Any topic freeing into the shared slab may give this one a block
+    if (!MessageSlab::instance.wait_free_unsafe(left)) break;
+#else
+    bool signaled;
+    ++num_alloc_waiters;
+    if (forever) {
+      alloc_sem.wait_unsafe();
+      signaled = true;
+    } else {
+      signaled = alloc_sem.wait_unsafe(left);
+    }
+    if (--num_alloc_waiters == 0) {
+      alloc_sem.reset_unsafe();
+    }
+    if (!signaled) break;
+#endif
+  }
+  SysLock::release();
+  return msgp;
+}
+
+
 bool Topic::notify_locals(Message &msg, const Time &timestamp) {
 
   if (has_local_subscribers()) {
@@ -100,6 +194,9 @@ bool Topic::notify_locals(Message &msg, const Time &timestamp) {
       msg.acquire();
       if (!i->notify(msg, timestamp)) {
         msg.release();
+        count_delivery(*i, false);
+      } else {
+        count_delivery(*i, true);
       }
     }
   }
@@ -127,6 +224,9 @@ bool Topic::notify_remotes(Message &msg, const Time &timestamp) {
     msg.acquire();
     if (!i->notify(msg, timestamp)) {
       msg.release();
+      count_delivery(*i, false);
+    } else {
+      count_delivery(*i, true);
     }
   }
 
@@ -137,6 +237,7 @@ bool Topic::notify_remotes(Message &msg, const Time &timestamp) {
 bool Topic::forward_copy(const Message &msg, const Time &timestamp) {
 
   bool all = true;
+  const bool patching = requires_patching(msg);
 
   for (StaticList<RemoteSubscriber>::Iterator i = remote_subscribers.begin();
        i != remote_subscribers.end(); ++i) {
@@ -148,6 +249,17 @@ bool Topic::forward_copy(const Message &msg, const Time &timestamp) {
     }
 #endif
 
+    if (!patching) {
+      // Same contents for every transport, share the message
+      Message &shared = const_cast<Message &>(msg);
+      shared.acquire();
+      if (!i->notify(shared, timestamp)) {
+        shared.release();
+        all = false;
+      }
+      continue;
+    }
+
     Message *msgp;
     if (alloc(msgp)) {
       Message::copy(*msgp, msg, get_type_size());
@@ -212,6 +324,42 @@ void Topic::subscribe(RemoteSubscriber &sub, size_t queue_length) {
 }
 
 
+void Topic::count_delivery(BaseSubscriber &sub, bool delivered) {
+
+#if R2P_USE_TRAFFIC_COUNTERS
+  SysLock::acquire();
+  if (delivered) {
+    ++sub.counters.deliveries;
+    ++counters.deliveries;
+  } else {
+    ++sub.counters.queue_drops;
+    ++counters.queue_drops;
+  }
+  SysLock::release();
+#else
+  (void)sub;
+  (void)delivered;
+#endif
+}
+
+
+bool Topic::requires_patching(const Message &msg) const {
+
+  if (this != &Middleware::instance.get_mgmt_topic()) return false;
+
+  switch (static_cast<const MgmtMsg &>(msg).type) {
+  case MgmtMsg::ADVERTISE:
+  case MgmtMsg::SUBSCRIBE_REQUEST:
+  case MgmtMsg::SUBSCRIBE_RESPONSE: {
+    return true;
+  }
+  default: {
+    return false;
+  }
+  }
+}
+
+
 void Topic::patch_pubsub_msg(Message &msg, Transport &transport) const {
 
   if (this != &Middleware::instance.get_mgmt_topic()) return;
@@ -236,8 +384,19 @@ void Topic::patch_pubsub_msg(Message &msg, Transport &transport) const {
 Topic::Topic(const char *namep, size_t type_size, bool forwarding)
 :
   namep(namep),
-  publish_timeout(Time::INFINITE),
+  name_hash(TopicIndex::hash(namep)),
+  // Static topics may be built before Time::INFINITE is
+  publish_timeout(Time::MAX_US + 1),
+#if R2P_USE_SHARED_MSG_POOL
+  type_size(type_size),
+  slab_class(MessageSlab::NUM_CLASSES),
+  pool_quota(0),
+#else
   msg_pool(type_size),
+  alloc_sem(0),
+  num_alloc_waiters(0),
+#endif
+  num_allocated(0),
   num_local_publishers(0),
   num_remote_publishers(0),
   max_queue_length(0),
@@ -0,0 +1,74 @@
+
+#include <r2p/TopicIndex.hpp>
+#include <r2p/Topic.hpp>
+#include <r2p/NamingTraits.hpp>
+
+namespace r2p {
+
+
+bool TopicIndex::insert(Topic &topic) {
+
+  if (count >= capacity) {
+    // Table full, lookups must fall back to the topic list
+    complete = false;
+    return false;
+  }
+
+  register size_t i = topic.get_name_hash() % length;
+  while (tablep[i] != NULL) {
+    if (tablep[i] == &topic) return true;
+    if (++i >= length) i = 0;
+  }
+  tablep[i] = &topic;
+  ++count;
+  return true;
+}
+
+
+Topic *TopicIndex::find(const char *namep) const {
+
+  if (namep == NULL || count == 0) return NULL;
+
+  const uint32_t h = hash(namep);
+  register size_t i = h % length;
+  for (size_t probes = 0; probes < length && tablep[i] != NULL; ++probes) {
+    if (tablep[i]->get_name_hash() == h &&
+        Topic::has_name(*tablep[i], namep)) {
+      return tablep[i];
+    }
+    if (++i >= length) i = 0;
+  }
+  return NULL;
+}
+
+
+TopicIndex::TopicIndex(Topic *table[], size_t length)
+:
+  tablep(table),
+  length((table != NULL) ? length : 0),
+  capacity(this->length - this->length / 4),
+  count(0),
+  complete(true)
+{
+  for (size_t i = 0; i < this->length; ++i) {
+    tablep[i] = NULL;
+  }
+}
+
+
+uint32_t TopicIndex::hash(const char *namep) {
+
+  if (namep == NULL) return 0;
+
+  // FNV-1a over the bounded topic name
+  register uint32_t h = 2166136261u;
+  for (size_t i = 0;
+       i < NamingTraits<Topic>::MAX_LENGTH && namep[i] != 0; ++i) {
+    h ^= static_cast<uint8_t>(namep[i]);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+
+} // namespace r2p
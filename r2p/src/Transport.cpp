@@ -6,7 +6,6 @@
 #include <r2p/RemoteSubscriber.hpp>
 #include <r2p/TimestampedMsgPtrQueue.hpp>
 #include <r2p/ScopedLock.hpp>
-#include "r2p/transport/RTCANPublisher.hpp"
 
 namespace r2p {
 
@@ -18,7 +17,10 @@ bool Transport::touch_publisher(Topic &topic, const uint8_t raw_params[]) {
   // Check if the remote publisher already exists
   RemotePublisher *pubp;
   pubp = publishers.find_first(BasePublisher::has_topic, topic.get_name());
-  if (pubp != NULL) return true;
+  if (pubp != NULL) {
+    refresh_publisher(*pubp, raw_params);
+    return true;
+  }
 
   // Create a new remote publisher
   pubp = create_publisher(topic, raw_params);
@@ -128,9 +130,156 @@ void Transport::fill_raw_params(const Topic &topic, uint8_t raw_params[]) {
 }
 
 
+void Transport::flush_tx_unsafe() {
+
+  // The TX thread was already woken by notify_tx_unsafe()
+}
+
+
+void Transport::flush_tx_list_unsafe(Transport *headp) {
+
+  while (headp != NULL) {
+    Transport &transport = *headp;
+    headp = transport.tx_flush_nextp;
+    transport.tx_flush_nextp = NULL;
+    transport.tx_flush_linked = false;
+    transport.flush_tx_unsafe();
+  }
+}
+
+
+void Transport::refresh_publisher(RemotePublisher &pub,
+                                  const uint8_t raw_params[]) {
+
+  (void)pub;
+  (void)raw_params;
+}
+
+
+// Weight-biased leftist heap: each node is heavier on its left, so the right
+// spines are at most log2(n + 1) long. Merged top-down along them, without
+// recursion, as it runs from interrupt handlers too.
+RemoteSubscriber *Transport::merge_tx(RemoteSubscriber *ap,
+                                      RemoteSubscriber *bp) {
+
+  RemoteSubscriber *rootp = NULL;
+  RemoteSubscriber **linkpp = &rootp;
+  while (ap != NULL && bp != NULL) {
+    if (bp->tx_deadline < ap->tx_deadline) {
+      RemoteSubscriber *tmpp = ap;
+      ap = bp;
+      bp = tmpp;
+    }
+
+    // ap stays on top, bp is merged into one of its subtrees
+    ap->tx_weight += bp->tx_weight;
+    *linkpp = ap;
+    const size_t left_weight = (ap->tx_leftp != NULL) ?
+                               ap->tx_leftp->tx_weight : 0;
+    if (left_weight >= ap->tx_weight - 1 - left_weight) {
+      linkpp = &ap->tx_rightp;
+      ap = ap->tx_rightp;
+    } else {
+      RemoteSubscriber *rightp = ap->tx_rightp;
+      ap->tx_rightp = ap->tx_leftp;
+      linkpp = &ap->tx_leftp;
+      ap = rightp;
+    }
+  }
+  *linkpp = (ap != NULL) ? ap : bp;
+  return rootp;
+}
+
+
+void Transport::schedule_tx_unsafe(RemoteSubscriber &sub) {
+
+  TimestampedMsgPtrQueue::Entry head;
+  if (sub.tx_weight > 0 || !sub.peek_unsafe(head)) return;
+
+  const Topic &topic = *sub.get_topic();
+  if (topic.get_publish_timeout() != Time::INFINITE) {
+    sub.tx_deadline = topic.compute_deadline_unsafe(head.timestamp);
+  } else {
+    sub.tx_deadline = head.timestamp +
+                      Time::ms(R2P_TRANSPORT_UNTIMED_TX_DELAY_MS);
+  }
+  sub.tx_weight = 1;
+  tx_rootp = merge_tx(tx_rootp, &sub);
+}
+
+
+void Transport::unschedule_tx_unsafe() {
+
+  RemoteSubscriber &sub = *tx_rootp;
+  tx_rootp = merge_tx(sub.tx_leftp, sub.tx_rightp);
+  sub.tx_leftp = NULL;
+  sub.tx_rightp = NULL;
+  sub.tx_weight = 0;
+}
+
+
+RemoteSubscriber *Transport::peek_tx_unsafe() {
+
+  // Earliest deadline first: the subscriber on top of the heap
+  const Time now = Time::now();
+  RemoteSubscriber *subp;
+  while ((subp = tx_rootp) != NULL) {
+    TimestampedMsgPtrQueue::Entry head;
+    if (subp->peek_unsafe(head) &&
+        subp->get_topic()->compute_slack_unsafe(head.timestamp, now) >=
+        Time::IMMEDIATE) {
+      return subp;
+    }
+
+    // Too late already, do not waste bandwidth on it
+    unschedule_tx_unsafe();
+    Message *msgp;
+    Time timestamp;
+    if (subp->fetch_unsafe(msgp, timestamp)) {
+      subp->release_unsafe(*msgp);
+      ++num_tx_expired;
+    }
+    schedule_tx_unsafe(*subp);
+  }
+  return NULL;
+}
+
+
+RemoteSubscriber *Transport::fetch_tx_unsafe(Message *&msgp, Time &deadline) {
+
+  RemoteSubscriber *subp = peek_tx_unsafe();
+  if (subp != NULL) {
+    unschedule_tx_unsafe();
+    Time timestamp;
+    subp->fetch_unsafe(msgp, timestamp);
+    deadline = subp->get_topic()->compute_deadline_unsafe(timestamp);
+    schedule_tx_unsafe(*subp);
+  }
+  return subp;
+}
+
+
+RemoteSubscriber *Transport::fetch_tx(Message *&msgp, Time &deadline) {
+
+  SysLock::acquire();
+  RemoteSubscriber *subp;
+  while ((subp = fetch_tx_unsafe(msgp, deadline)) == NULL) {
+    tx_waiting = true;
+    tx_sem.wait_unsafe();
+  }
+  SysLock::release();
+  return subp;
+}
+
+
 Transport::Transport(const char *namep)
 :
   namep(namep),
+  tx_rootp(NULL),
+  tx_waiting(false),
+  num_tx_expired(0),
+  tx_flush_nextp(NULL),
+  tx_flush_linked(false),
   by_middleware(*this)
 {
   R2P_ASSERT(is_identifier(namep, NamingTraits<Transport>::MAX_LENGTH));
@@ -4,7 +4,6 @@
 #include <r2p/transport/DebugSubscriber.hpp>
 #include <r2p/Middleware.hpp>
 #include <r2p/ScopedLock.hpp>
-#include <r2p/Checksummer.hpp>
 
 #include <cstring>
 #include <locale>
@@ -15,11 +14,46 @@ namespace r2p {
 #define RECV_DELAY_MS   0//5
 
 
+bool DebugTransport::fill_rx(systime_t timeout) {
+
+  // Take whatever is already there; block only when there is nothing at all
+  rxhead = rxtail = 0;
+  size_t length = chnReadTimeout(channelp, rxbuf, RX_BUFFER_LENGTH,
+                                 TIME_IMMEDIATE);
+  if (length == 0) {
+    register msg_t value = chnGetTimeout(channelp, timeout);
+    if ((value & ~0xFF) != 0) return false;
+    rxbuf[0] = static_cast<uint8_t>(value);
+    length = 1 + chnReadTimeout(channelp, &rxbuf[1], RX_BUFFER_LENGTH - 1,
+                                TIME_IMMEDIATE);
+  }
+  rxtail = length;
+  return true;
+}
+
+
+bool DebugTransport::skip_to_frame_start(char &start, systime_t timeout) {
+
+  // Named ('@'), compact ID ('#') or binary ('\0') frames; scan the buffer
+  // directly instead of going through get_rx() for each skipped byte
+  for (;;) {
+    while (rxhead < rxtail) {
+      register const uint8_t c = rxbuf[rxhead++];
+      if (c == '@' || c == '#' || c == 0) {
+        start = static_cast<char>(c);
+        return true;
+      }
+    }
+    if (!fill_rx(timeout)) return false;
+  }
+}
+
+
 bool DebugTransport::skip_after_char(char c, systime_t timeout) {
 
   register msg_t value;
   do {
-    value = chnGetTimeout(channelp, timeout);
+    value = get_rx(timeout);
     if ((value & ~0xFF) != 0) return false;
   } while (static_cast<char>(value) != c);
   return true;
@@ -30,7 +64,7 @@ bool DebugTransport::recv_byte(uint8_t &byte, systime_t timeout) {
 
   msg_t c;
 
-  c = chnGetTimeout(channelp, timeout);
+  c = get_rx(timeout);
   if        ((c >= '0' && c <= '9')) {
     byte = static_cast<uint8_t>(c - '0') << 4;
   } else if ((c >= 'A' && c <= 'F')) {
@@ -41,7 +75,7 @@ bool DebugTransport::recv_byte(uint8_t &byte, systime_t timeout) {
     return false;
   }
 
-  c = chnGetTimeout(channelp, timeout);
+  c = get_rx(timeout);
   if        ((c >= '0' && c <= '9')) {
     byte |= static_cast<uint8_t>(c - '0');
   } else if ((c >= 'A' && c <= 'F')) {
@@ -120,6 +154,149 @@ bool DebugTransport::recv_string(char *stringp, size_t length,
 }
 
 
+bool DebugTransport::write_tx(const uint8_t *chunkp, size_t length,
+                              systime_t timeout) {
+
+  while (length > 0) {
+    if (txlen >= TX_BUFFER_LENGTH && !flush_tx(timeout)) return false;
+    size_t chunklen = TX_BUFFER_LENGTH - txlen;
+    if (chunklen > length) chunklen = length;
+    memcpy(&txbuf[txlen], chunkp, chunklen);
+    txlen += chunklen;
+    chunkp += chunklen;
+    length -= chunklen;
+  }
+  return true;
+}
+
+
+bool DebugTransport::flush_tx(systime_t timeout) {
+
+  // Bytes the channel did not take stay buffered in order, so the frames
+  // already packed are not lost
+  if (txlen == 0) return true;
+  const size_t length = chnWriteTimeout(channelp, txbuf, txlen, timeout);
+  if (length > txframe) {
+    txframe_written = true;
+  }
+  txframe = txframe_written ? 0 : (txframe - length);
+  if (length >= txlen) {
+    txlen = 0;
+    return true;
+  }
+  memmove(txbuf, &txbuf[length], txlen - length);
+  txlen -= length;
+  return false;
+}
+
+
+bool DebugTransport::send_frame(const uint8_t *framep, size_t length,
+                                systime_t timeout) {
+
+  // COBS: each block is prefixed by its length + 1 and stands for the bytes
+  // up to the next zero, which is dropped; 0xFF marks a full block without
+  // a zero. Frames are delimited by zeros on both sides.
+  if (!put_tx(0, timeout)) return false;
+  const uint8_t *const endp = framep + length;
+  for (;;) {
+    const uint8_t *blockp = framep;
+    while (framep < endp && *framep != 0 && framep - blockp < 0xFE) {
+      ++framep;
+    }
+    const uint8_t code = static_cast<uint8_t>(framep - blockp + 1);
+    if (!put_tx(code, timeout)) return false;
+    if (!write_tx(blockp, code - 1, timeout)) return false;
+    if (framep >= endp) break;
+    if (code != 0xFF) ++framep; // Skip the encoded zero
+  }
+  return put_tx(0, timeout);
+}
+
+
+bool DebugTransport::begin_cobs(systime_t timeout) {
+
+  // Skip any further delimiters, then read the first block length
+  register msg_t code;
+  do {
+    code = get_rx(timeout);
+    if ((code & ~0xFF) != 0) return false;
+  } while (code == 0);
+  cobs_left = static_cast<uint8_t>(code - 1);
+  cobs_zero = (code != 0xFF);
+  return true;
+}
+
+
+bool DebugTransport::recv_cobs(void *chunkp, size_t length,
+                               systime_t timeout) {
+
+  uint8_t *p = reinterpret_cast<uint8_t *>(chunkp);
+  while (length > 0) {
+    if (cobs_left == 0) {
+      if (cobs_zero) {
+        // The previous block was short, so it stands for a zero
+        cobs_zero = false;
+        *p++ = 0;
+        --length;
+        continue;
+      }
+      register msg_t code = get_rx(timeout);
+      if ((code & ~0xFF) != 0 || code == 0) return false;
+      cobs_left = static_cast<uint8_t>(code - 1);
+      cobs_zero = (code != 0xFF);
+      continue;
+    }
+    // Copy as much of the block as is already buffered, in one go
+    if (rxhead >= rxtail && !fill_rx(timeout)) return false;
+    size_t chunklen = rxtail - rxhead;
+    if (chunklen > cobs_left) chunklen = cobs_left;
+    if (chunklen > length) chunklen = length;
+    if (memchr(&rxbuf[rxhead], 0, chunklen) != NULL) return false;
+    memcpy(p, &rxbuf[rxhead], chunklen);
+    rxhead += chunklen;
+    p += chunklen;
+    cobs_left -= static_cast<uint8_t>(chunklen);
+    length -= chunklen;
+  }
+  return true;
+}
+
+
+bool DebugTransport::end_cobs(systime_t timeout) {
+
+  if (cobs_left != 0) return false;
+
+  // A frame ending with a zero has a trailing empty block
+  register msg_t c = get_rx(timeout);
+  if (c == 1 && !cobs_zero) {
+    c = get_rx(timeout);
+  }
+  return c == 0;
+}
+
+
+bool DebugTransport::recv_field(void *valuep, size_t length, bool binary) {
+
+  // Binary values are little-endian, hex values are printed big-endian
+  if (binary) return recv_cobs(valuep, length);
+  return recv_chunk_rev(valuep, length);
+}
+
+
+bool DebugTransport::expect_separator(bool binary) {
+
+  return binary || expect_char(':');
+}
+
+
+bool DebugTransport::send_checksum(const LinkChecksummer &cs) {
+
+  // Only the low bytes, as many as the algorithm produces
+  const uint32_t checksum = cs.compute_checksum();
+  return send_chunk_rev(&checksum, cs.get_length());
+}
+
+
 bool DebugTransport::send_msg(const Message &msg, size_t msg_size,
                               const char *topicp, const Time &deadline) {
 
@@ -127,13 +304,14 @@ bool DebugTransport::send_msg(const Message &msg, size_t msg_size,
   R2P_ASSERT(msg.get_source() != this);
 #endif
 
-  Checksummer cs;
+  LinkChecksummer cs(get_checksum_algorithm());
 
-  // Send the deadline
+  // Send the deadline, truncated to 32 bits to keep the frame format
+  const uint32_t deadline_raw = static_cast<uint32_t>(deadline.raw);
   if (!send_char('@')) return false;
-  if (!send_value(deadline.raw)) return false;
+  if (!send_value(deadline_raw)) return false;
   if (!send_char(':')) return false;
-  cs.add(deadline.raw);
+  cs.add(deadline_raw);
 
   // Send the topic name
   uint8_t namelen = static_cast<uint8_t>(
@@ -154,7 +332,46 @@ bool DebugTransport::send_msg(const Message &msg, size_t msg_size,
 
   // Send the checksum
   if (!send_char(':')) return false;
-  if (!send_value(cs.compute_checksum())) return false;
+  if (!send_checksum(cs)) return false;
+
+  // End of packet
+  if (!send_char('\r') || !send_char('\n')) return false;
+  return true;
+}
+
+
+bool DebugTransport::send_msg(const Message &msg, size_t msg_size,
+                              uint8_t topic_id, const Time &deadline) {
+
+#if R2P_USE_BRIDGE_MODE
+  R2P_ASSERT(msg.get_source() != this);
+#endif
+  R2P_ASSERT(topic_id < MAX_TOPIC_IDS);
+
+  LinkChecksummer cs(get_checksum_algorithm());
+
+  // Send the deadline, truncated to 32 bits to keep the frame format
+  const uint32_t deadline_raw = static_cast<uint32_t>(deadline.raw);
+  if (!send_char('#')) return false;
+  if (!send_value(deadline_raw)) return false;
+  if (!send_char(':')) return false;
+  cs.add(deadline_raw);
+
+  // Send the compact topic ID
+  if (!send_value(topic_id)) return false;
+  cs.add(topic_id);
+
+  // Send the payload length and data
+  if (!send_char(':')) return false;
+  uint8_t length = static_cast<uint8_t>(msg_size);
+  if (!send_value(length)) return false;
+  if (!send_chunk(msg.get_raw_data(), msg_size)) return false;
+  cs.add(length);
+  cs.add(msg.get_raw_data(), msg_size);
+
+  // Send the checksum
+  if (!send_char(':')) return false;
+  if (!send_checksum(cs)) return false;
 
   // End of packet
   if (!send_char('\r') || !send_char('\n')) return false;
@@ -162,12 +379,115 @@ bool DebugTransport::send_msg(const Message &msg, size_t msg_size,
 }
 
 
+bool DebugTransport::send_msg_binary(const Message &msg, size_t msg_size,
+                                     const char *topicp, uint8_t topic_id,
+                                     const Time &deadline) {
+
+#if R2P_USE_BRIDGE_MODE
+  R2P_ASSERT(msg.get_source() != this);
+#endif
+  R2P_ASSERT(msg_size <= BINARY_MAX_PAYLOAD);
+
+  // Same fields as the ASCII frames, as raw bytes without separators
+  uint8_t *p = frame_buf;
+  const uint32_t deadline_raw = static_cast<uint32_t>(deadline.raw);
+  *p++ = (topic_id != NO_TOPIC_ID) ? '#' : '@';
+  memcpy(p, &deadline_raw, sizeof(deadline_raw));
+  p += sizeof(deadline_raw);
+  if (topic_id != NO_TOPIC_ID) {
+    *p++ = topic_id;
+  } else {
+    const uint8_t namelen = static_cast<uint8_t>(
+      strnlen(topicp, NamingTraits<Topic>::MAX_LENGTH)
+    );
+    *p++ = namelen;
+    memcpy(p, topicp, namelen);
+    p += namelen;
+  }
+  *p++ = static_cast<uint8_t>(msg_size);
+  memcpy(p, msg.get_raw_data(), msg_size);
+  p += msg_size;
+
+  LinkChecksummer cs(get_checksum_algorithm());
+  cs.add(frame_buf + 1, static_cast<size_t>(p - frame_buf - 1));
+  const uint32_t checksum = cs.compute_checksum();
+  memcpy(p, &checksum, cs.get_length());
+  p += cs.get_length();
+
+  return send_frame(frame_buf, static_cast<size_t>(p - frame_buf));
+}
+
+
+void DebugTransport::fill_raw_params(const Topic &topic,
+                                     uint8_t raw_params[]) {
+
+  if (raw_params == NULL) return;
+
+  memset(raw_params, 0, MgmtMsg::PubSub::MAX_RAW_PARAMS_LENGTH);
+  raw_params[RAW_MAGIC0_OFFSET] = RAW_MAGIC0;
+  raw_params[RAW_MAGIC1_OFFSET] = RAW_MAGIC1;
+
+  // Tell the peer which ID this side uses when sending the topic
+  const DebugSubscriber *subp = static_cast<const DebugSubscriber *>(
+    subscribers.find_first(BaseSubscriber::has_topic, topic.get_name())
+  );
+  raw_params[RAW_TOPIC_ID_OFFSET] =
+    (subp != NULL) ? subp->get_topic_id() : static_cast<uint8_t>(NO_TOPIC_ID);
+  raw_params[RAW_FLAGS_OFFSET] = binary_enabled ? RAW_FLAG_BINARY : 0;
+}
+
+
+void DebugTransport::map_topic_id(RemotePublisher &pub,
+                                  const uint8_t raw_params[]) {
+
+  if (raw_params == NULL ||
+      raw_params[RAW_MAGIC0_OFFSET] != RAW_MAGIC0 ||
+      raw_params[RAW_MAGIC1_OFFSET] != RAW_MAGIC1) {
+    return;
+  }
+
+  uint8_t topic_id = raw_params[RAW_TOPIC_ID_OFFSET];
+  if (topic_id >= MAX_TOPIC_IDS) return;
+
+  SysLock::acquire();
+  for (unsigned i = 0; i < MAX_TOPIC_IDS; ++i) {
+    if (id_publishers[i] == &pub) {
+      id_publishers[i] = NULL;
+    }
+  }
+  id_publishers[topic_id] = &pub;
+  SysLock::release();
+}
+
+
+void DebugTransport::check_peer_params(const MgmtMsg &msg) {
+
+  switch (msg.type) {
+  case MgmtMsg::ADVERTISE:
+  case MgmtMsg::SUBSCRIBE_REQUEST:
+  case MgmtMsg::SUBSCRIBE_RESPONSE: {
+    // A peer restarted with an older or a plain ASCII build falls back to
+    // named frames
+    if (msg.pubsub.raw_params[RAW_MAGIC0_OFFSET] == RAW_MAGIC0 &&
+        msg.pubsub.raw_params[RAW_MAGIC1_OFFSET] == RAW_MAGIC1) {
+      peer_topic_ids = true;
+      peer_binary = (msg.pubsub.raw_params[RAW_FLAGS_OFFSET] &
+                     RAW_FLAG_BINARY) != 0;
+    } else {
+      peer_topic_ids = false;
+      peer_binary = false;
+    }
+    break;
+  }
+  }
+}
+
+
 void DebugTransport::initialize(void *rx_stackp, size_t rx_stacklen,
                                 Thread::Priority rx_priority,
                                 void *tx_stackp, size_t tx_stacklen,
                                 Thread::Priority tx_priority) {
 
-  subp_sem.initialize();
   send_lock.initialize();
 
   // Create the transmission pump thread
@@ -183,10 +503,11 @@ void DebugTransport::initialize(void *rx_stackp, size_t rx_stacklen,
   // Clear any previous crap caused by serial port initialization
   bool success; (void)success;
   send_lock.acquire();
-  success = send_string("\r\n\r\n", 4);
+  success = send_string("\r\n\r\n", 4) && flush_tx();
   R2P_ASSERT(success);
   send_lock.release();
 
+#if R2P_USE_BOOTLOADER
   if (Middleware::instance.is_bootloader_mode()) {
     // Register remote publisher and subscriber for the bootloader thread
     const char *namep = Middleware::instance.get_boot_topic().get_name();
@@ -195,6 +516,7 @@ void DebugTransport::initialize(void *rx_stackp, size_t rx_stacklen,
     success = subscribe(boot_rsub, namep, boot_msgbuf, BOOT_BUFFER_LENGTH);
     R2P_ASSERT(success);
   }
+#endif
 
   // Register remote publisher and subscriber for the management thread
   success = advertise(mgmt_rpub, "R2P", Time::INFINITE, sizeof(MgmtMsg));
@@ -208,103 +530,146 @@ void DebugTransport::initialize(void *rx_stackp, size_t rx_stacklen,
 
 bool DebugTransport::spin_tx() {
 
+  // Earliest deadline first, late messages are dropped by the scheduler.
+  // Frames are packed into as few writes as possible: the buffer is sent
+  // when it fills up, or before blocking for the next message.
   Message *msgp;
-  Time timestamp;
-  const BaseSubscriberQueue::Link *subp_linkp;
-
+  Time deadline;
   SysLock::acquire();
-  subp_sem.wait_unsafe();
-  subp_queue.peek_unsafe(subp_linkp);
-  R2P_ASSERT(subp_linkp->itemp != NULL);
-  DebugSubscriber &sub = static_cast<DebugSubscriber &>(*subp_linkp->itemp);
-  size_t queue_length = sub.get_queue_count();
-  R2P_ASSERT(queue_length > 0);
+  RemoteSubscriber *subp = fetch_tx_unsafe(msgp, deadline);
   SysLock::release();
-
-  bool requeued = false;
-  while (queue_length-- > 0) {
-    SysLock::acquire();
-    sub.fetch_unsafe(msgp, timestamp);
-    if (queue_length == 0) {
-      subp_queue.skip_unsafe();
-
-      // Check if there are more messages than the ones expected
-      if (!requeued && sub.get_queue_count() > 0) {
-        requeued = true;
-        notify_first_sub_unsafe(sub);   // Put this sub into the queue again
-      }
-    }
-    SysLock::release();
-
+  if (subp == NULL) {
     send_lock.acquire();
-    const Topic &topic = *sub.get_topic();
-    if (!send_msg(*msgp, topic.get_payload_size(), topic.get_name(),
-                  timestamp + topic.get_publish_timeout())) {
-      sub.release(*msgp);
+    bool flushed = flush_tx();
+    send_lock.release();
+    if (!flushed) return false;
+    subp = fetch_tx(msgp, deadline);
+  }
+  DebugSubscriber &sub = static_cast<DebugSubscriber &>(*subp);
+
+  send_lock.acquire();
+  const Topic &topic = *sub.get_topic();
+  txframe = txlen;
+  txframe_written = false;
+  bool sent;
+  if (binary_enabled && peer_binary &&
+      topic.get_payload_size() <= BINARY_MAX_PAYLOAD) {
+    sent = send_msg_binary(*msgp, topic.get_payload_size(),
+                           topic.get_name(), sub.get_topic_id(), deadline);
+  } else if (peer_topic_ids && sub.get_topic_id() != NO_TOPIC_ID) {
+    sent = send_msg(*msgp, topic.get_payload_size(), sub.get_topic_id(),
+                    deadline);
+  } else {
+    sent = send_msg(*msgp, topic.get_payload_size(), topic.get_name(),
+                    deadline);
+  }
+  sub.release(*msgp);
+  if (!sent) {
+    if (!txframe_written) {
+      // Drop the partial frame, keep the ones packed before it
+      txlen = txframe;
+    } else {
+      // Its head is out, end it so that the peer skips to the next one
       send_char('\r');
       send_char('\n');
-      send_lock.release();
-      return false;
     }
-    sub.release(*msgp);
-    send_lock.release();
   }
-  return true;
+  send_lock.release();
+  return sent;
 }
 
 
 bool DebugTransport::spin_rx() {
 
-  Checksummer cs;
+  LinkChecksummer cs(get_checksum_algorithm());
 
-  // Skip the deadline
-  if (!skip_after_char('@')) return false;
+  // Skip to the start of a frame, named ('@') or with a compact ID ('#'),
+  // or to the zero delimiter of a binary frame
+  char start;
+  if (!skip_to_frame_start(start)) return false;
 #if RECV_DELAY_MS
   Thread::sleep(Time::ms(100));
 #endif
-  { Time deadline;
-  if (!recv_value(deadline.raw)) return false;
-  cs.add(deadline.raw); }
 
-  // Receive the topic name length and data
-  if (!expect_char(':')) return false;
-  uint8_t length;
-  if (!recv_value(length)) return false;
-  if (length == 0 || length > NamingTraits<Topic>::MAX_LENGTH) return false;
-  memset(namebufp, 0, NamingTraits<Topic>::MAX_LENGTH);
-  if (!recv_string(namebufp, length)) return false;
-  if (!expect_char(':')) return false;
-  cs.add(length);
-  cs.add(namebufp, length);
+  // Binary frames carry the same fields, COBS-encoded and without separators
+  const bool binary = (start == '\0');
+  if (binary) {
+    if (!begin_cobs() || !recv_cobs(&start, 1)) return false;
+    if (start != '@' && start != '#') return false;
+  }
 
-  // Check if the topic is known
-  Topic *topicp = Middleware::instance.find_topic(namebufp);
-  if (topicp == NULL) return false;
+  // Skip the deadline
+  { uint32_t deadline_raw;
+  if (!recv_field(&deadline_raw, sizeof(deadline_raw), binary)) return false;
+  cs.add(deadline_raw); }
+  if (!expect_separator(binary)) return false;
+
+  Topic *topicp;
   RemotePublisher *pubp;
-  pubp = publishers.find_first(BasePublisher::has_topic, topicp->get_name());
-  if (pubp == NULL) return false;
+  uint8_t length;
+  if (start == '#') {
+    // Resolve the topic ID assigned by the peer
+    uint8_t topic_id;
+    if (!recv_field(&topic_id, 1, binary)) return false;
+    if (!expect_separator(binary)) return false;
+    cs.add(topic_id);
+    if (topic_id >= MAX_TOPIC_IDS) return false;
+    pubp = id_publishers[topic_id];
+    if (pubp == NULL) return false;
+    topicp = pubp->get_topic();
+  } else {
+    // Receive the topic name length and data
+    if (!recv_field(&length, 1, binary)) return false;
+    if (length == 0 || length > NamingTraits<Topic>::MAX_LENGTH) return false;
+    memset(namebufp, 0, NamingTraits<Topic>::MAX_LENGTH);
+    if (binary) {
+      if (!recv_cobs(namebufp, length)) return false;
+    } else {
+      if (!recv_string(namebufp, length)) return false;
+    }
+    if (!expect_separator(binary)) return false;
+    cs.add(length);
+    cs.add(namebufp, length);
+
+    // Check if the topic is known
+    topicp = Middleware::instance.find_topic(namebufp);
+    if (topicp == NULL) return false;
+    pubp = publishers.find_first(BasePublisher::has_topic, topicp->get_name());
+    if (pubp == NULL) return false;
+  }
 
   // Get the payload length
-  if (!recv_value(length)) return false;
+  if (!recv_field(&length, 1, binary)) return false;
   if (length != topicp->get_payload_size()) return false;
   cs.add(length);
 
   // Get the payload data
   Message *msgp;
   if (!pubp->alloc(msgp)) return false;
-#if R2P_USE_BRIDGE_MODE
+  // Freed on every error path, and when nobody subscribes
   MessageGuard guard(*msgp, *topicp);
+#if R2P_USE_BRIDGE_MODE
   msgp->set_source(this);
 #endif
-  if (!recv_chunk(const_cast<uint8_t *>(msgp->get_raw_data()), length)) {
+  uint8_t *const datap = const_cast<uint8_t *>(msgp->get_raw_data());
+  if (binary ? !recv_cobs(datap, length) : !recv_chunk(datap, length)) {
     return false;
   }
   cs.add(msgp->get_raw_data(), length);
 
   // Get the checksum
-  if (!expect_char(':') || !recv_value(length) || !cs.check(length)) {
+  uint32_t checksum = 0;
+  if (!expect_separator(binary) ||
+      !recv_field(&checksum, cs.get_length(), binary) ||
+      !cs.check(checksum)) {
     return false;
   }
+  if (binary && !end_cobs()) return false;
+
+  // Learn whether the peer understands compact topic IDs
+  if (topicp == &Middleware::instance.get_mgmt_topic()) {
+    check_peer_params(*static_cast<const MgmtMsg *>(msgp));
+  }
 
   // Forward the message locally
 #if R2P_USE_BRIDGE_MODE
@@ -346,22 +711,40 @@ Thread::Return DebugTransport::tx_threadf(Thread::Argument arg) {
 
 
 DebugTransport::DebugTransport(const char *namep, BaseChannel *channelp,
-                               char namebuf[])
+                               char namebuf[],
+                               LinkChecksummer::Algorithm checksum_algorithm)
 :
   Transport(namep),
   rx_threadp(NULL),
   tx_threadp(NULL),
   channelp(channelp),
   namebufp(namebuf),
-  subp_sem(false),
   send_lock(false),
+  txlen(0),
+  txframe(0),
+  txframe_written(false),
+  rxhead(0),
+  rxtail(0),
+  checksum_algorithm(static_cast<uint8_t>(checksum_algorithm)),
+  next_topic_id(0),
+  peer_topic_ids(false),
+  binary_enabled(false),
+  peer_binary(false),
+  cobs_left(0),
+  cobs_zero(false),
   mgmt_rsub(*this, mgmt_msgqueue_buf, MGMT_BUFFER_LENGTH),
-  mgmt_rpub(*this),
-  boot_rsub(*this, boot_msgqueue_buf, BOOT_BUFFER_LENGTH),
+  mgmt_rpub(*this)
+#if R2P_USE_BOOTLOADER
+  , boot_rsub(*this, boot_msgqueue_buf, BOOT_BUFFER_LENGTH),
   boot_rpub(*this)
+#endif
 {
   R2P_ASSERT(channelp != NULL);
   R2P_ASSERT(namebuf != NULL);
+
+  for (unsigned i = 0; i < MAX_TOPIC_IDS; ++i) {
+    id_publishers[i] = NULL;
+  }
 }
 
 
@@ -2,7 +2,9 @@
 #include <r2p/transport/RTCANPublisher.hpp>
 #include <r2p/transport/RTCANSubscriber.hpp>
 #include <r2p/Middleware.hpp>
+#include <r2p/TopicIndex.hpp>
 
+#include <cstring>
 #include <rtcan.h>
 
 //FIXME needed for header pool, should use abstract allocator
@@ -11,27 +13,46 @@
 
 namespace r2p {
 
-bool RTCANTransport::send(Message * msgp, RTCANSubscriber * rsubp) {
-	rtcan_msg_t * rtcan_msg_p;
+void RTCANTransport::pump_tx_unsafe() {
+	Message * msgp;
+	Time deadline;
+
+	// Hand the most urgent messages to the driver while there are free headers,
+	// the others wait (or expire) in the subscriber queues
+	for (;;) {
+		rtcan_msg_t * rtcan_msg_p = header_pool.alloc_unsafe();
+		if (rtcan_msg_p == NULL) return;
+
+		RTCANSubscriber * rsubp = static_cast<RTCANSubscriber *>(fetch_tx_unsafe(msgp, deadline));
+		if (rsubp == NULL) {
+			header_pool.free_unsafe(rtcan_msg_p);
+			return;
+		}
 
 #if R2P_USE_BRIDGE_MODE
-	R2P_ASSERT(msgp->get_source() != this);
+		R2P_ASSERT(msgp->get_source() != this);
 #endif
 
-	// Allocate RTCAN msg header
-	rtcan_msg_p = header_pool.alloc_unsafe();
-	if (rtcan_msg_p == NULL)
-		return false;
-
-	rtcan_msg_p->id = rsubp->rtcan_id;
-	rtcan_msg_p->callback = reinterpret_cast<rtcan_msgcallback_t>(send_cb);
-	rtcan_msg_p->params = rsubp;
-	rtcan_msg_p->size = rsubp->get_topic()->get_payload_size();
-	rtcan_msg_p->data = msgp->get_raw_data();
-	rtcan_msg_p->status = RTCAN_MSG_READY;
+		rtcan_msg_p->id = rsubp->rtcan_id;
+		rtcan_msg_p->callback = reinterpret_cast<rtcan_msgcallback_t>(send_cb);
+		rtcan_msg_p->params = rsubp;
+		rtcan_msg_p->size = rsubp->get_topic()->get_payload_size();
+		rtcan_msg_p->data = msgp->get_raw_data();
+		rtcan_msg_p->status = RTCAN_MSG_READY;
+
+		// Give the driver the time left, up to the usual timeout
+		Time::Type timeout_ms = TX_TIMEOUT_MS;
+		if (deadline != Time::INFINITE) {
+			timeout_ms = (deadline - Time::now()).to_ms_raw();
+			if (timeout_ms < 1) timeout_ms = 1;
+			if (timeout_ms > TX_TIMEOUT_MS) timeout_ms = TX_TIMEOUT_MS;
+		}
+		rtcanTransmitI(&rtcan, rtcan_msg_p, static_cast<uint32_t>(timeout_ms));
+	}
+}
 
-	rtcanTransmitI(&rtcan, rtcan_msg_p, 50);
-	return true;
+void RTCANTransport::flush_tx_unsafe() {
+	pump_tx_unsafe();
 }
 
 void RTCANTransport::send_cb(rtcan_msg_t &rtcan_msg) {
@@ -41,12 +62,19 @@ void RTCANTransport::send_cb(rtcan_msg_t &rtcan_msg) {
 
 	rsubp->release_unsafe(msg);
 	transport->header_pool.free_unsafe(&rtcan_msg);
+	transport->pump_tx_unsafe();
 }
 
 void RTCANTransport::recv_cb(rtcan_msg_t &rtcan_msg) {
 	RTCANPublisher* pubp = static_cast<RTCANPublisher *>(rtcan_msg.params);
 	Message *msgp = const_cast<Message *>(&Message::get_msg_from_raw_data(rtcan_msg.data));
 
+	// Keep track of the slots announced by the other nodes
+	if (pubp->get_topic() == &Middleware::instance.get_mgmt_topic()) {
+		static_cast<RTCANTransport *>(pubp->get_transport())
+			->learn_slot_unsafe(*static_cast<const MgmtMsg *>(msgp));
+	}
+
 #if R2P_USE_BRIDGE_MODE
 	R2P_ASSERT(pubp->get_transport() != NULL);
 	{ MessageGuardUnsafe guard(*msgp, *pubp->get_topic());
@@ -98,17 +126,32 @@ RemotePublisher *RTCANTransport::create_publisher(Topic &topic, const uint8_t ra
 
 RemoteSubscriber *RTCANTransport::create_subscriber(Topic &topic, TimestampedMsgPtrQueue::Entry queue_buf[],
 		size_t queue_length) const {
-	RTCANSubscriber *rsubp = new RTCANSubscriber(*const_cast<RTCANTransport *>(this), queue_buf, queue_length);
+	RTCANTransport &self = *const_cast<RTCANTransport *>(this);
+	RTCANSubscriber *rsubp = new RTCANSubscriber(self, queue_buf, queue_length);
 
-	// TODO: dynamic ID arbitration
-
-	rsubp->rtcan_id = topic_id(topic);
+	rsubp->rtcan_id = self.topic_id(topic);
 
 	return rsubp;
 }
 
+void RTCANTransport::refresh_publisher(RemotePublisher &pub, const uint8_t raw_params[]) {
+	if (raw_params == NULL || raw_params[RAW_MAGIC0_OFFSET] != RAW_MAGIC0 || raw_params[RAW_MAGIC1_OFFSET] != RAW_MAGIC1) return;
+
+	// The peer moved the topic to another slot; the driver matches the
+	// filter against the header, so updating its ID is enough
+	RTCANPublisher &rpub = static_cast<RTCANPublisher &>(pub);
+	SysLock::acquire();
+	memcpy(&rpub.rtcan_header.id, raw_params + RAW_ID_OFFSET, sizeof(rtcan_id_t));
+	SysLock::release();
+}
+
 void RTCANTransport::fill_raw_params(const Topic &topic, uint8_t raw_params[]) {
-	*reinterpret_cast<rtcan_id_t *>(raw_params) = topic_id(topic);
+	if (raw_params == NULL) return;
+
+	// Announce the ID this node sends the topic with
+	*reinterpret_cast<rtcan_id_t *>(raw_params + RAW_ID_OFFSET) = topic_id(topic);
+	raw_params[RAW_MAGIC0_OFFSET] = RAW_MAGIC0;
+	raw_params[RAW_MAGIC1_OFFSET] = RAW_MAGIC1;
 }
 
 void RTCANTransport::initialize(const RTCANConfig &rtcan_config) {
@@ -128,26 +171,236 @@ void RTCANTransport::initialize(const RTCANConfig &rtcan_config) {
 }
 
 RTCANTransport::RTCANTransport(RTCANDriver &rtcan) :
-		Transport("rtcan"), rtcan(rtcan), header_pool(header_buffer, 10), mgmt_rsub(NULL), mgmt_rpub(NULL) {
+		Transport("rtcan"), rtcan(rtcan), header_pool(header_buffer, 10), mgmt_rsub(NULL), mgmt_rpub(NULL),
+		num_assignments(0), num_priority_overrides(0) {
+	R2P_ASSERT(ID_MIN > NO_SLOT && ID_MIN <= ID_MAX && ID_MAX < 0xFF);
+	R2P_ASSERT(ID_MAX - ID_MIN + 1 >= NUM_PRIORITIES);
 }
 
 RTCANTransport::~RTCANTransport() {
 }
 
 
-rtcan_id_t RTCANTransport::topic_id(const Topic &topic) const {
-	const StaticList<Topic> & topic_list = Middleware::instance.get_topics();
+// To be set before the topic is advertised, as slots are kept once taken
+bool RTCANTransport::set_priority(const char *namep, uint8_t priority) {
+	R2P_ASSERT(priority < NUM_PRIORITIES);
+	SysLock::Scope lock;
+
+	PriorityOverride *overridep = NULL;
+	for (size_t i = 0; i < num_priority_overrides; ++i) {
+		if (strncmp(priority_overrides[i].topic, namep, NamingTraits<Topic>::MAX_LENGTH) == 0) {
+			overridep = &priority_overrides[i];
+			break;
+		}
+	}
+	if (overridep == NULL) {
+		if (num_priority_overrides >= MAX_PRIORITY_OVERRIDES) return false;
+		overridep = &priority_overrides[num_priority_overrides++];
+		strncpy(overridep->topic, namep, NamingTraits<Topic>::MAX_LENGTH);
+	}
+	overridep->priority = priority;
+	return true;
+}
+
+
+rtcan_id_t RTCANTransport::topic_id(const Topic &topic) {
 	Topic & mgmt_topic = Middleware::instance.get_mgmt_topic();
-	int index = topic_list.index_of(topic);
-	rtcan_id_t rtcan_id;
 
 	// id 0 reserved to management topic
 	if (&topic == &mgmt_topic) return ((0x00 << 8) & stm32_id8());
 
-	if (index < 0) return (255 << 8);
+	uint8_t slot = allocate_slot(topic);
+	if (slot == NO_SLOT) return (255 << 8);
+
+	return (static_cast<rtcan_id_t>(slot) << 8) | stm32_id8();
+}
+
+
+uint8_t RTCANTransport::allocate_slot(const Topic &topic) {
+	const char *namep = topic.get_name();
+	SysLock::Scope lock;
+
+	// Reuse the slot of the topic, if already known on the bus
+	Assignment *assignmentp = find_assignment_unsafe(namep);
+	if (assignmentp != NULL) {
+		assignmentp->topicp = &topic;
+		return assignmentp->slot;
+	}
+
+	uint8_t slot = find_free_slot_unsafe(namep, topic.get_publish_timeout());
+	if (slot != NO_SLOT) {
+		assign_slot_unsafe(namep, slot, &topic);
+	}
+	return slot;
+}
+
+
+uint8_t RTCANTransport::find_priority_unsafe(const char *namep, const Time &publish_timeout) const {
+	for (size_t i = 0; i < num_priority_overrides; ++i) {
+		if (strncmp(priority_overrides[i].topic, namep, NamingTraits<Topic>::MAX_LENGTH) == 0) {
+			return priority_overrides[i].priority;
+		}
+	}
+	return compute_priority(publish_timeout);
+}
+
+
+uint8_t RTCANTransport::find_free_slot_unsafe(const char *namep, const Time &publish_timeout) const {
+	// Prefer a slot which depends only on the urgency class and the name, so
+	// that it stays the same across reboots and registration orders
+	const unsigned span = ID_MAX - ID_MIN + 1;
+	const unsigned width = span / NUM_PRIORITIES;
+	unsigned offset = find_priority_unsafe(namep, publish_timeout) * width +
+	                  TopicIndex::hash(namep) % width;
+
+	// Otherwise take the next free one, with lower priority
+	for (unsigned i = 0; i < span; ++i) {
+		uint8_t slot = static_cast<uint8_t>(ID_MIN + (offset + i) % span);
+		if (!is_slot_taken_unsafe(slot)) return slot;
+	}
+	return NO_SLOT;
+}
+
 
-	rtcan_id = ((index & 0x0F) << 12) | ((stm32_id8() & 0x0F) << 8) | stm32_id8();
-	return rtcan_id;
+void RTCANTransport::learn_slot_unsafe(const MgmtMsg &msg) {
+	if (msg.type != MgmtMsg::ADVERTISE && msg.type != MgmtMsg::SUBSCRIBE_RESPONSE) return;
+
+	const uint8_t *raw_params = msg.pubsub.raw_params;
+	if (raw_params[RAW_MAGIC0_OFFSET] != RAW_MAGIC0 || raw_params[RAW_MAGIC1_OFFSET] != RAW_MAGIC1) return;
+
+	rtcan_id_t rtcan_id;
+	memcpy(&rtcan_id, raw_params + RAW_ID_OFFSET, sizeof(rtcan_id));
+	uint8_t slot = static_cast<uint8_t>(rtcan_id >> 8);
+	if (slot < ID_MIN || slot > ID_MAX) return;
+
+	const char *namep = msg.pubsub.topic;
+	Assignment *ownerp = find_owner_unsafe(slot);
+	Assignment *assignmentp = find_assignment_unsafe(namep);
+	if (ownerp != NULL && ownerp != assignmentp) {
+		// Collision: the topic with the lower name hash moves
+		if (!wins_slot(namep, ownerp->topic)) {
+			// Show the peer that the slot is ours, it will move
+			if (ownerp->topicp != NULL) advertise_slot_unsafe(*ownerp);
+			return;
+		}
+		if (ownerp->topicp != NULL) {
+			uint8_t newslot = find_free_slot_unsafe(ownerp->topic, ownerp->topicp->get_publish_timeout());
+			move_slot_unsafe(*ownerp, newslot);
+			if (newslot != NO_SLOT) advertise_slot_unsafe(*ownerp);
+		} else {
+			// Learned from another peer, which is going to move it
+			move_slot_unsafe(*ownerp, NO_SLOT);
+		}
+	}
+
+	// Follow the peers when they move a topic
+	if (assignmentp != NULL) {
+		move_slot_unsafe(*assignmentp, slot);
+	} else {
+		assign_slot_unsafe(namep, slot, NULL);
+	}
+}
+
+
+bool RTCANTransport::is_slot_taken_unsafe(uint8_t slot) const {
+	for (size_t i = 0; i < num_assignments; ++i) {
+		if (assignments[i].slot == slot) return true;
+	}
+	return false;
+}
+
+
+RTCANTransport::Assignment *RTCANTransport::find_assignment_unsafe(const char *namep) {
+	for (size_t i = 0; i < num_assignments; ++i) {
+		if (0 == strncmp(assignments[i].topic, namep, NamingTraits<Topic>::MAX_LENGTH)) {
+			return &assignments[i];
+		}
+	}
+	return NULL;
+}
+
+
+RTCANTransport::Assignment *RTCANTransport::find_owner_unsafe(uint8_t slot) {
+	for (size_t i = 0; i < num_assignments; ++i) {
+		if (assignments[i].slot == slot) return &assignments[i];
+	}
+	return NULL;
+}
+
+
+RTCANTransport::Assignment *RTCANTransport::assign_slot_unsafe(const char *namep, uint8_t slot, const Topic *topicp) {
+	// When full, the slot is still used, just not protected from collisions
+	if (num_assignments >= MAX_ASSIGNMENTS) return NULL;
+
+	Assignment &assignment = assignments[num_assignments++];
+	strncpy(assignment.topic, namep, NamingTraits<Topic>::MAX_LENGTH);
+	assignment.topicp = topicp;
+	assignment.slot = slot;
+	return &assignment;
+}
+
+
+void RTCANTransport::move_slot_unsafe(Assignment &assignment, uint8_t slot) {
+	assignment.slot = slot;
+	if (assignment.topicp == NULL) return;
+
+	// Messages still queued leave with the new ID as well; with no slot
+	// left, the topic falls back to the lowest priority, as in topic_id()
+	rtcan_id_t upper = (slot != NO_SLOT) ? slot : 255;
+	for (StaticList<RemoteSubscriber>::IteratorUnsafe i = subscribers.begin_unsafe();
+	     i != subscribers.end_unsafe(); ++i) {
+		if (i->get_topic() == assignment.topicp) {
+			RTCANSubscriber &rsub = static_cast<RTCANSubscriber &>(*i);
+			rsub.rtcan_id = (upper << 8) | (rsub.rtcan_id & 0xFF);
+		}
+	}
+}
+
+
+void RTCANTransport::advertise_slot_unsafe(const Assignment &assignment) {
+	// Called from the RX callback, so the message goes straight to the bus
+	// instead of through the management thread
+	Topic &mgmt_topic = Middleware::instance.get_mgmt_topic();
+	MgmtMsg *msgp = static_cast<MgmtMsg *>(mgmt_topic.alloc_unsafe());
+	if (msgp == NULL) return;
+
+	Message::reset_payload(*msgp);
+	msgp->type = MgmtMsg::ADVERTISE;
+	strncpy(msgp->pubsub.topic, assignment.topic, NamingTraits<Topic>::MAX_LENGTH);
+	msgp->pubsub.payload_size = static_cast<uint16_t>(assignment.topicp->get_payload_size());
+	rtcan_id_t rtcan_id = (static_cast<rtcan_id_t>(assignment.slot) << 8) | stm32_id8();
+	memcpy(msgp->pubsub.raw_params + RAW_ID_OFFSET, &rtcan_id, sizeof(rtcan_id));
+	msgp->pubsub.raw_params[RAW_MAGIC0_OFFSET] = RAW_MAGIC0;
+	msgp->pubsub.raw_params[RAW_MAGIC1_OFFSET] = RAW_MAGIC1;
+
+	msgp->acquire_unsafe();
+	if (mgmt_rsub->notify_unsafe(*msgp, Time::now())) {
+		flush_tx_unsafe();
+	} else {
+		mgmt_topic.release_unsafe(*msgp);
+	}
+}
+
+
+bool RTCANTransport::wins_slot(const char *namep, const char *otherp) {
+	uint32_t hash = TopicIndex::hash(namep);
+	uint32_t other = TopicIndex::hash(otherp);
+	if (hash != other) return hash > other;
+	return strncmp(namep, otherp, NamingTraits<Topic>::MAX_LENGTH) > 0;
+}
+
+
+uint8_t RTCANTransport::compute_priority(const Time &publish_timeout) {
+	if (publish_timeout == Time::INFINITE) return NUM_PRIORITIES - 1;
+
+	// One class per power of two of milliseconds: 0, 1, 2-3, 4-7, ...
+	Time::Type ms = publish_timeout.to_ms_raw();
+	uint8_t priority = 0;
+	while (ms > 0 && priority < NUM_PRIORITIES - 1) {
+		ms >>= 1;
+		++priority;
+	}
+	return priority;
 }
 
 /*
@@ -0,0 +1,16 @@
+
+#include <r2p/transport/ShmPublisher.hpp>
+
+namespace r2p {
+
+
+ShmPublisher::ShmPublisher(Transport &transport)
+:
+  RemotePublisher(transport)
+  {}
+
+
+ShmPublisher::~ShmPublisher() {}
+
+
+} // namespace r2p
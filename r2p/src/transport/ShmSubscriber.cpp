@@ -0,0 +1,19 @@
+
+#include <r2p/transport/ShmSubscriber.hpp>
+#include <r2p/transport/ShmTransport.hpp>
+
+namespace r2p {
+
+
+ShmSubscriber::ShmSubscriber(ShmTransport &transport,
+                             TimestampedMsgPtrQueue::Entry queue_buf[],
+                             size_t queue_length)
+:
+  RemoteSubscriber(transport, queue_buf, queue_length)
+{}
+
+
+ShmSubscriber::~ShmSubscriber() {}
+
+
+} // namespace r2p
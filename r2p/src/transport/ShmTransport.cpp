@@ -0,0 +1,306 @@
+
+#include <r2p/transport/ShmTransport.hpp>
+#include <r2p/Middleware.hpp>
+
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace r2p {
+
+
+bool ShmTransport::open_segment() {
+
+  return (side == SIDE_A) ? create_segment() : attach_segment();
+}
+
+
+bool ShmTransport::create_segment() {
+
+  fd = shm_open(shm_namep, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    if (errno != EEXIST) return false;
+
+    // Left by a previous run: replace it, unless somebody still uses it
+    int oldfd = shm_open(shm_namep, O_RDONLY, 0);
+    if (oldfd < 0) return false;
+    struct stat st;
+    bool busy = false;
+    if (fstat(oldfd, &st) == 0 &&
+        st.st_size >= static_cast<off_t>(sizeof(Segment))) {
+      void *addrp = mmap(NULL, sizeof(Segment), PROT_READ, MAP_SHARED,
+                         oldfd, 0);
+      if (addrp != MAP_FAILED) {
+        const Segment *oldp = reinterpret_cast<const Segment *>(addrp);
+        busy = oldp->magic == MAGIC &&
+               (is_alive(oldp->pids[SIDE_A]) || is_alive(oldp->pids[SIDE_B]));
+        munmap(addrp, sizeof(Segment));
+      }
+    }
+    close(oldfd);
+    if (busy || shm_unlink(shm_namep) < 0) return false;
+
+    fd = shm_open(shm_namep, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd < 0) return false;
+  }
+  if (ftruncate(fd, sizeof(Segment)) < 0) return false;
+
+  void *addrp = mmap(NULL, sizeof(Segment), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+  if (addrp == MAP_FAILED) return false;
+  segmentp = reinterpret_cast<Segment *>(addrp);
+
+  // Nobody else maps the new segment before the magic is set
+  for (unsigned i = 0; i < 2; ++i) {
+    Ring &ring = segmentp->rings[i];
+    if (sem_init(&ring.sem, 1, 0) < 0) return false;
+    ring.head = 0;
+    ring.tail = 0;
+    ring.num_drops = 0;
+  }
+  segmentp->pids[SIDE_A] = getpid();
+  segmentp->pids[SIDE_B] = 0;
+  __sync_synchronize();
+  segmentp->magic = MAGIC;
+  return true;
+}
+
+
+bool ShmTransport::attach_segment() {
+
+  // Wait for a segment completely set up by a running side A; one left by
+  // a previous run is skipped until side A replaces it
+  for (;;) {
+    fd = shm_open(shm_namep, O_RDWR, 0);
+    if (fd < 0 && errno != ENOENT) return false;
+    if (fd >= 0) {
+      struct stat st;
+      if (fstat(fd, &st) < 0) return false;
+      if (st.st_size >= static_cast<off_t>(sizeof(Segment))) {
+        void *addrp = mmap(NULL, sizeof(Segment), PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd, 0);
+        if (addrp == MAP_FAILED) return false;
+        segmentp = reinterpret_cast<Segment *>(addrp);
+        if (segmentp->magic == MAGIC && is_alive(segmentp->pids[SIDE_A])) {
+          __sync_synchronize();
+          segmentp->pids[SIDE_B] = getpid();
+          return true;
+        }
+        munmap(addrp, sizeof(Segment));
+        segmentp = NULL;
+      }
+      close(fd);
+      fd = -1;
+    }
+    Thread::sleep(Time::ms(10));
+  }
+}
+
+
+bool ShmTransport::push(const Topic &topic, const Message &msg) {
+
+  R2P_ASSERT(topic.get_payload_size() <= MAX_PAYLOAD);
+
+  Ring &ring = get_tx_ring();
+  const uint32_t head = ring.head;
+  if (head - ring.tail >= RING_LENGTH) {
+    ++ring.num_drops; // The receiver is not keeping up
+    return false;
+  }
+
+  Slot &slot = ring.slots[head & (RING_LENGTH - 1)];
+  const size_t namelen = strnlen(topic.get_name(),
+                                 NamingTraits<Topic>::MAX_LENGTH);
+  slot.namelen = static_cast<uint8_t>(namelen);
+  memcpy(slot.name, topic.get_name(), namelen);
+  slot.length = static_cast<uint16_t>(topic.get_payload_size());
+  memcpy(slot.data, msg.get_raw_data(), topic.get_payload_size());
+
+  // Publish the slot only once it is completely written
+  __sync_synchronize();
+  ring.head = head + 1;
+  return true;
+}
+
+
+bool ShmTransport::dispatch(const Slot &slot) {
+
+  // Check if the topic is known
+  char namebuf[NamingTraits<Topic>::MAX_LENGTH];
+  if (slot.namelen == 0 || slot.namelen > NamingTraits<Topic>::MAX_LENGTH) {
+    return false;
+  }
+  memset(namebuf, 0, NamingTraits<Topic>::MAX_LENGTH);
+  memcpy(namebuf, slot.name, slot.namelen);
+  Topic *topicp = Middleware::instance.find_topic(namebuf);
+  if (topicp == NULL) return false;
+  RemotePublisher *pubp = publishers.find_first(BasePublisher::has_topic,
+                                                topicp->get_name());
+  if (pubp == NULL) return false;
+  if (slot.length != topicp->get_payload_size()) return false;
+
+  Message *msgp;
+  if (!pubp->alloc(msgp)) return false;
+  // Freed on every error path, and when nobody subscribes
+  MessageGuard guard(*msgp, *topicp);
+#if R2P_USE_BRIDGE_MODE
+  msgp->set_source(this);
+#endif
+  memcpy(const_cast<uint8_t *>(msgp->get_raw_data()), slot.data,
+         slot.length);
+
+  // Forward the message locally
+#if R2P_USE_BRIDGE_MODE
+  bool success = pubp->publish_locally(*msgp);
+  if (topicp->is_forwarding()) {
+    success = success && pubp->publish_remotely(*msgp);
+  }
+  return success;
+#else
+  return pubp->publish_locally(*msgp);
+#endif
+}
+
+
+bool ShmTransport::initialize(void *rx_stackp, size_t rx_stacklen,
+                              Thread::Priority rx_priority,
+                              void *tx_stackp, size_t tx_stacklen,
+                              Thread::Priority tx_priority) {
+
+
+  if (!open_segment()) return false;
+
+  // Create the transmission pump thread
+  tx_threadp = Thread::create_static(tx_stackp, tx_stacklen, tx_priority,
+                                     tx_threadf, this, "SHM_TX");
+  R2P_ASSERT(tx_threadp != NULL);
+
+  // Create the reception pump thread
+  rx_threadp = Thread::create_static(rx_stackp, rx_stacklen, rx_priority,
+                                     rx_threadf, this, "SHM_RX");
+  R2P_ASSERT(rx_threadp != NULL);
+
+  // Register remote publisher and subscriber for the management thread
+  bool success; (void)success;
+  success = advertise(mgmt_rpub, "R2P", Time::INFINITE, sizeof(MgmtMsg));
+  R2P_ASSERT(success);
+  success = subscribe(mgmt_rsub, "R2P", mgmt_msgbuf, MGMT_BUFFER_LENGTH);
+  R2P_ASSERT(success);
+
+  Middleware::instance.add(*this);
+  return true;
+}
+
+
+bool ShmTransport::spin_tx() {
+
+  // Earliest deadline first, late messages are dropped by the scheduler
+  Message *msgp;
+  Time deadline;
+  RemoteSubscriber *subp = fetch_tx(msgp, deadline);
+
+  // Push whatever is pending, then wake up the receiver once
+  bool success = true;
+  do {
+    const Topic &topic = *subp->get_topic();
+    if (!push(topic, *msgp)) {
+      success = false;
+    }
+    subp->release(*msgp);
+
+    SysLock::acquire();
+    subp = fetch_tx_unsafe(msgp, deadline);
+    SysLock::release();
+  } while (subp != NULL);
+
+  if (sem_post(&get_tx_ring().sem) < 0) {
+    success = false;
+  }
+  return success;
+}
+
+
+bool ShmTransport::spin_rx() {
+
+  Ring &ring = get_rx_ring();
+  if (sem_wait(&ring.sem) < 0) return false;
+
+  // Drain everything, more slots may have come after the wakeup
+  bool success = true;
+  uint32_t tail = ring.tail;
+  while (tail != ring.head) {
+    __sync_synchronize();
+    success = dispatch(ring.slots[tail & (RING_LENGTH - 1)]) && success;
+    __sync_synchronize();
+    ring.tail = ++tail;
+  }
+  return success;
+}
+
+
+bool ShmTransport::is_alive(pid_t pid) {
+
+  return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+
+Thread::Return ShmTransport::rx_threadf(Thread::Argument arg) {
+
+  R2P_ASSERT(arg != static_cast<Thread::Argument>(NULL));
+
+  // Reception pump
+  for (;;) {
+    register bool ok;
+    ok = reinterpret_cast<ShmTransport *>(arg)->spin_rx();
+    (void)ok;
+  }
+  return static_cast<Thread::Return>(0);
+}
+
+
+Thread::Return ShmTransport::tx_threadf(Thread::Argument arg) {
+
+  R2P_ASSERT(arg != static_cast<Thread::Argument>(NULL));
+
+  // Transmission pump
+  for (;;) {
+    reinterpret_cast<ShmTransport *>(arg)->spin_tx();
+  }
+  return static_cast<Thread::Return>(0);
+}
+
+
+ShmTransport::ShmTransport(const char *namep, const char *shm_namep,
+                           Side side)
+:
+  Transport(namep),
+  rx_threadp(NULL),
+  tx_threadp(NULL),
+  shm_namep(shm_namep),
+  side(static_cast<uint8_t>(side)),
+  fd(-1),
+  segmentp(NULL),
+  mgmt_rsub(*this, mgmt_msgqueue_buf, MGMT_BUFFER_LENGTH),
+  mgmt_rpub(*this)
+{
+  R2P_ASSERT(shm_namep != NULL && shm_namep[0] == '/');
+  R2P_ASSERT((RING_LENGTH & (RING_LENGTH - 1)) == 0);
+}
+
+
+ShmTransport::~ShmTransport() {
+
+  if (segmentp != NULL) {
+    segmentp->pids[side] = 0;
+    munmap(segmentp, sizeof(Segment));
+  }
+  if (fd >= 0) close(fd);
+  if (side == SIDE_A) shm_unlink(shm_namep);
+}
+
+
+} // namespace r2p
@@ -0,0 +1,16 @@
+
+#include <r2p/transport/UdpPublisher.hpp>
+
+namespace r2p {
+
+
+UdpPublisher::UdpPublisher(Transport &transport)
+:
+  RemotePublisher(transport)
+  {}
+
+
+UdpPublisher::~UdpPublisher() {}
+
+
+} // namespace r2p
@@ -0,0 +1,19 @@
+
+#include <r2p/transport/UdpSubscriber.hpp>
+#include <r2p/transport/UdpTransport.hpp>
+
+namespace r2p {
+
+
+UdpSubscriber::UdpSubscriber(UdpTransport &transport,
+                             TimestampedMsgPtrQueue::Entry queue_buf[],
+                             size_t queue_length)
+:
+  RemoteSubscriber(transport, queue_buf, queue_length)
+{}
+
+
+UdpSubscriber::~UdpSubscriber() {}
+
+
+} // namespace r2p
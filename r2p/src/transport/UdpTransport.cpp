@@ -0,0 +1,397 @@
+
+#include <r2p/transport/UdpTransport.hpp>
+#include <r2p/Middleware.hpp>
+#include <r2p/TopicIndex.hpp>
+
+#include <cstring>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace r2p {
+
+
+bool UdpTransport::open_sockets() {
+
+  struct sockaddr_in addr;
+  socklen_t addrlen = sizeof(addr);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+  // Unicast data socket, also the source of the management datagrams
+  data_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (data_fd < 0) return false;
+  addr.sin_port = htons(data_port);
+  if (bind(data_fd, reinterpret_cast<struct sockaddr *>(&addr),
+           sizeof(addr)) < 0) {
+    return false;
+  }
+  if (getsockname(data_fd, reinterpret_cast<struct sockaddr *>(&addr),
+                  &addrlen) < 0) {
+    return false;
+  }
+  data_port = ntohs(addr.sin_port);
+
+  // Keep the multicast loopback, other modules may run on this host
+  unsigned char loop = 1;
+  if (setsockopt(data_fd, IPPROTO_IP, IP_MULTICAST_LOOP,
+                 &loop, sizeof(loop)) < 0) {
+    return false;
+  }
+
+  // Management socket, shared by all the modules of this host
+  mgmt_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (mgmt_fd < 0) return false;
+  int on = 1;
+  if (setsockopt(mgmt_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0) {
+    return false;
+  }
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = group.port;
+  if (bind(mgmt_fd, reinterpret_cast<struct sockaddr *>(&addr),
+           sizeof(addr)) < 0) {
+    return false;
+  }
+  struct ip_mreq mreq;
+  mreq.imr_multiaddr.s_addr = group.addr;
+  mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+  return setsockopt(mgmt_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+                    &mreq, sizeof(mreq)) == 0;
+}
+
+
+size_t UdpTransport::begin_datagram(const Topic &topic) {
+
+  uint8_t *p = txbuf;
+  *p++ = MAGIC0;
+  *p++ = MAGIC1;
+  *p++ = MAGIC2;
+  *p++ = MAGIC3;
+  *p++ = static_cast<uint8_t>(sender_id >> 24);
+  *p++ = static_cast<uint8_t>(sender_id >> 16);
+  *p++ = static_cast<uint8_t>(sender_id >> 8);
+  *p++ = static_cast<uint8_t>(sender_id);
+
+  const size_t namelen = strnlen(topic.get_name(),
+                                 NamingTraits<Topic>::MAX_LENGTH);
+  *p++ = static_cast<uint8_t>(namelen);
+  memcpy(p, topic.get_name(), namelen);
+  p += namelen;
+
+  const size_t payload_size = topic.get_payload_size();
+  *p++ = static_cast<uint8_t>(payload_size >> 8);
+  *p++ = static_cast<uint8_t>(payload_size);
+  return static_cast<size_t>(p - txbuf);
+}
+
+
+bool UdpTransport::send_datagram(const Topic &topic, size_t length) {
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+
+  // Management messages are for everybody
+  if (&topic == &Middleware::instance.get_mgmt_topic()) {
+    addr.sin_addr.s_addr = group.addr;
+    addr.sin_port = group.port;
+    return sendto(data_fd, txbuf, length, 0,
+                  reinterpret_cast<struct sockaddr *>(&addr),
+                  sizeof(addr)) == static_cast<ssize_t>(length);
+  }
+
+  // Data only to the modules which subscribed to the topic
+  bool success = true;
+  routes_lock.acquire();
+  for (size_t i = 0; i < num_routes; ++i) {
+    if (!Topic::has_name(topic, routes[i].topic)) continue;
+    addr.sin_addr.s_addr = routes[i].endpoint.addr;
+    addr.sin_port = routes[i].endpoint.port;
+    if (sendto(data_fd, txbuf, length, 0,
+               reinterpret_cast<struct sockaddr *>(&addr),
+               sizeof(addr)) != static_cast<ssize_t>(length)) {
+      success = false;
+    }
+  }
+  routes_lock.release();
+  return success;
+}
+
+
+bool UdpTransport::recv_datagram(int fd, Endpoint &source, size_t &length) {
+
+  struct sockaddr_in addr;
+  socklen_t addrlen = sizeof(addr);
+  ssize_t received = recvfrom(fd, rxbuf, DATAGRAM_LENGTH, 0,
+                              reinterpret_cast<struct sockaddr *>(&addr),
+                              &addrlen);
+  if (received <= 0 || addrlen < sizeof(addr)) return false;
+
+  source.addr = addr.sin_addr.s_addr;
+  source.port = addr.sin_port;
+  length = static_cast<size_t>(received);
+  return true;
+}
+
+
+bool UdpTransport::process_datagram(const Endpoint &source, size_t length) {
+
+  const uint8_t *p = rxbuf;
+  const uint8_t *const endp = rxbuf + length;
+
+  // Check the header, and skip the own looped back datagrams
+  if (length < HEADER_LENGTH + 1) return false;
+  if (p[0] != MAGIC0 || p[1] != MAGIC1 || p[2] != MAGIC2 || p[3] != MAGIC3) {
+    return false;
+  }
+  const uint32_t id = (static_cast<uint32_t>(p[4]) << 24) |
+                      (static_cast<uint32_t>(p[5]) << 16) |
+                      (static_cast<uint32_t>(p[6]) << 8) |
+                      static_cast<uint32_t>(p[7]);
+  if (id == sender_id) return true;
+  p += HEADER_LENGTH;
+
+  // Check if the topic is known
+  char namebuf[NamingTraits<Topic>::MAX_LENGTH];
+  const size_t namelen = *p++;
+  if (namelen == 0 || namelen > NamingTraits<Topic>::MAX_LENGTH) return false;
+  if (static_cast<size_t>(endp - p) < namelen + 2) return false;
+  memset(namebuf, 0, NamingTraits<Topic>::MAX_LENGTH);
+  memcpy(namebuf, p, namelen);
+  p += namelen;
+
+  Topic *topicp = Middleware::instance.find_topic(namebuf);
+  if (topicp == NULL) return false;
+  RemotePublisher *pubp = publishers.find_first(BasePublisher::has_topic,
+                                                topicp->get_name());
+  if (pubp == NULL) return false;
+
+  // The rest of the datagram is a whole number of payloads
+  const size_t payload_size = (static_cast<size_t>(p[0]) << 8) | p[1];
+  p += 2;
+  if (payload_size == 0 || payload_size != topicp->get_payload_size() ||
+      static_cast<size_t>(endp - p) % payload_size != 0) {
+    return false;
+  }
+
+  bool success = true;
+  for (; p < endp; p += payload_size) {
+    success = dispatch(*pubp, p, source) && success;
+  }
+  return success;
+}
+
+
+bool UdpTransport::dispatch(RemotePublisher &pub, const uint8_t *payloadp,
+                            const Endpoint &source) {
+
+  Message *msgp;
+  if (!pub.alloc(msgp)) return false;
+  Topic &topic = *pub.get_topic();
+  // Freed on every error path, and when nobody subscribes
+  MessageGuard guard(*msgp, topic);
+#if R2P_USE_BRIDGE_MODE
+  msgp->set_source(this);
+#endif
+  memcpy(const_cast<uint8_t *>(msgp->get_raw_data()), payloadp,
+         topic.get_payload_size());
+
+  // The subscription request comes from the data socket of the subscriber
+  if (&topic == &Middleware::instance.get_mgmt_topic()) {
+    const MgmtMsg &mgmt_msg = *static_cast<const MgmtMsg *>(msgp);
+    if (mgmt_msg.type == MgmtMsg::SUBSCRIBE_REQUEST) {
+      add_route(mgmt_msg.pubsub.topic, source);
+    }
+  }
+
+  // Forward the message locally
+#if R2P_USE_BRIDGE_MODE
+  bool success = pub.publish_locally(*msgp);
+  if (topic.is_forwarding()) {
+    success = success && pub.publish_remotely(*msgp);
+  }
+  return success;
+#else
+  return pub.publish_locally(*msgp);
+#endif
+}
+
+
+void UdpTransport::add_route(const char *topicp, const Endpoint &endpoint) {
+
+  routes_lock.acquire();
+  for (size_t i = 0; i < num_routes; ++i) {
+    if (routes[i].endpoint.addr == endpoint.addr &&
+        routes[i].endpoint.port == endpoint.port &&
+        0 == strncmp(routes[i].topic, topicp,
+                     NamingTraits<Topic>::MAX_LENGTH)) {
+      routes_lock.release();
+      return; // Already known
+    }
+  }
+  if (num_routes < MAX_ROUTES) {
+    strncpy(routes[num_routes].topic, topicp,
+            NamingTraits<Topic>::MAX_LENGTH);
+    routes[num_routes].endpoint = endpoint;
+    ++num_routes;
+  }
+  routes_lock.release();
+}
+
+
+bool UdpTransport::initialize(void *rx_stackp, size_t rx_stacklen,
+                              Thread::Priority rx_priority,
+                              void *tx_stackp, size_t tx_stacklen,
+                              Thread::Priority tx_priority) {
+
+  routes_lock.initialize();
+
+  if (!open_sockets()) return false;
+  sender_id = TopicIndex::hash(Middleware::instance.get_module_name()) ^
+              static_cast<uint32_t>(data_port);
+
+  // Create the transmission pump thread
+  tx_threadp = Thread::create_static(tx_stackp, tx_stacklen, tx_priority,
+                                     tx_threadf, this, "UDP_TX");
+  R2P_ASSERT(tx_threadp != NULL);
+
+  // Create the reception pump thread
+  rx_threadp = Thread::create_static(rx_stackp, rx_stacklen, rx_priority,
+                                     rx_threadf, this, "UDP_RX");
+  R2P_ASSERT(rx_threadp != NULL);
+
+  // Register remote publisher and subscriber for the management thread
+  bool success; (void)success;
+  success = advertise(mgmt_rpub, "R2P", Time::INFINITE, sizeof(MgmtMsg));
+  R2P_ASSERT(success);
+  success = subscribe(mgmt_rsub, "R2P", mgmt_msgbuf, MGMT_BUFFER_LENGTH);
+  R2P_ASSERT(success);
+
+  Middleware::instance.add(*this);
+  return true;
+}
+
+
+bool UdpTransport::spin_tx() {
+
+  // Earliest deadline first, late messages are dropped by the scheduler
+  Message *msgp;
+  Time deadline;
+  UdpSubscriber &sub = static_cast<UdpSubscriber &>(*fetch_tx(msgp,
+                                                              deadline));
+
+  const Topic &topic = *sub.get_topic();
+  const size_t payload_size = topic.get_payload_size();
+  const size_t start = begin_datagram(topic);
+  if (start + payload_size > DATAGRAM_LENGTH) {
+    sub.release(*msgp);
+    return false; // Would never fit into a datagram
+  }
+
+  // Pack messages into the datagram while the topic stays the most urgent
+  bool success = true;
+  size_t length = start;
+  bool more;
+  do {
+    if (length + payload_size > DATAGRAM_LENGTH) {
+      success = send_datagram(topic, length) && success;
+      length = start;
+    }
+    memcpy(&txbuf[length], msgp->get_raw_data(), payload_size);
+    length += payload_size;
+    sub.release(*msgp);
+
+    SysLock::acquire();
+    more = (peek_tx_unsafe() == &sub) && fetch_tx_unsafe(msgp, deadline);
+    SysLock::release();
+  } while (more);
+  return send_datagram(topic, length) && success;
+}
+
+
+bool UdpTransport::spin_rx() {
+
+  struct pollfd fds[2];
+  fds[0].fd = mgmt_fd;
+  fds[0].events = POLLIN;
+  fds[0].revents = 0;
+  fds[1].fd = data_fd;
+  fds[1].events = POLLIN;
+  fds[1].revents = 0;
+  if (poll(fds, 2, -1) <= 0) return false;
+
+  bool success = true;
+  for (unsigned i = 0; i < 2; ++i) {
+    if ((fds[i].revents & POLLIN) == 0) continue;
+    Endpoint source;
+    size_t length;
+    if (!recv_datagram(fds[i].fd, source, length) ||
+        !process_datagram(source, length)) {
+      success = false;
+    }
+  }
+  return success;
+}
+
+
+Thread::Return UdpTransport::rx_threadf(Thread::Argument arg) {
+
+  R2P_ASSERT(arg != static_cast<Thread::Argument>(NULL));
+
+  // Reception pump
+  for (;;) {
+    register bool ok;
+    ok = reinterpret_cast<UdpTransport *>(arg)->spin_rx();
+    (void)ok;
+  }
+  return static_cast<Thread::Return>(0);
+}
+
+
+Thread::Return UdpTransport::tx_threadf(Thread::Argument arg) {
+
+  R2P_ASSERT(arg != static_cast<Thread::Argument>(NULL));
+
+  // Transmission pump
+  for (;;) {
+    reinterpret_cast<UdpTransport *>(arg)->spin_tx();
+  }
+  return static_cast<Thread::Return>(0);
+}
+
+
+UdpTransport::UdpTransport(const char *namep, const char *group_addrp,
+                           uint16_t group_port, uint16_t data_port)
+:
+  Transport(namep),
+  rx_threadp(NULL),
+  tx_threadp(NULL),
+  data_port(data_port),
+  mgmt_fd(-1),
+  data_fd(-1),
+  sender_id(0),
+  routes_lock(false),
+  num_routes(0),
+  mgmt_rsub(*this, mgmt_msgqueue_buf, MGMT_BUFFER_LENGTH),
+  mgmt_rpub(*this)
+{
+  R2P_ASSERT(group_addrp != NULL);
+
+  group.addr = inet_addr(group_addrp);
+  group.port = htons(group_port);
+  R2P_ASSERT(IN_MULTICAST(ntohl(group.addr)));
+}
+
+
+UdpTransport::~UdpTransport() {
+
+  if (mgmt_fd >= 0) close(mgmt_fd);
+  if (data_fd >= 0) close(data_fd);
+}
+
+
+} // namespace r2p